@@ -0,0 +1,512 @@
+// Benchmark suite for the scheduler's data structures and tick loop.
+// Builds seeded synthetic workloads, drives the library directly and prints
+// one JSON object per line for each benchmark (throughput and latency
+// percentiles), so runs can be compared for regression tracking.
+// Usage: ./scheduler_bench [options] (see usage())
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include "scheduler.h"
+#include "persistence.h"
+
+// Workload and cluster settings
+typedef struct {
+    int nodes;          // Cluster size
+    int node_cpu;       // Capacity of every node
+    int node_ram;
+    int jobs;           // Jobs per benchmark
+    int ticks;          // Ticks the job stream is spread over
+    int max_priority;   // Priorities are uniform in [0, max_priority]
+    int max_cpu;        // Demands: 80% uniform in [1, max / 8], 20% in [1, max]
+    int max_ram;
+    int max_duration;   // Durations are uniform in [1, max_duration]
+    int threads;        // Threads collecting completions (1 = serial)
+    unsigned long long seed;
+    const char* queue;  // "heap", "bucket" or "all"
+    PlacementPolicy policy;
+    const char* state_file;
+} BenchConfig;
+
+// xorshift64*: the same stream for the same seed on every platform
+static unsigned long long rng_state;
+
+static void rng_seed(unsigned long long seed) {
+    rng_state = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+static unsigned long long rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1Dull;
+}
+
+// Uniform in [low, high]
+static int rng_range(int low, int high) {
+    return low + (int)(rng_next() % (unsigned long long)(high - low + 1));
+}
+
+// Mostly small demands with a tail of large ones
+static int rng_demand(int max) {
+    int small = max / 8 > 0 ? max / 8 : 1;
+    return rng_range(1, rng_next() % 5 == 0 ? max : small);
+}
+
+static long long now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Fill a job with the next draw from the workload
+static void generate_job(const BenchConfig* config, Job* job, int job_id, int arrival_time) {
+    job->job_id = job_id;
+    job->priority = rng_range(0, config->max_priority);
+    job->required_cpu = rng_demand(config->max_cpu);
+    job->required_ram = rng_demand(config->max_ram);
+    job->duration = rng_range(1, config->max_duration);
+    job->status = 0; // Pending
+    job->arrival_time = arrival_time;
+    job->start_time = -1;
+    job->finish_time = -1;
+}
+
+static int compare_ns(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Print one result line. samples holds per-operation latencies (sorted here)
+static void report(const char* bench, const char* variant, long long ops, long long total_ns,
+                   long long* samples, int count, const char* extra) {
+    double seconds = total_ns / 1e9;
+    printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"ops\":%lld,\"seconds\":%.6f,\"ops_per_sec\":%.1f",
+           bench, variant, ops, seconds, seconds > 0 ? ops / seconds : 0.0);
+    if (count > 0) {
+        qsort(samples, count, sizeof(long long), compare_ns);
+        printf(",\"p50_ns\":%lld,\"p90_ns\":%lld,\"p99_ns\":%lld,\"p999_ns\":%lld,\"max_ns\":%lld",
+               samples[(int)(0.5 * (count - 1))], samples[(int)(0.9 * (count - 1))],
+               samples[(int)(0.99 * (count - 1))], samples[(int)(0.999 * (count - 1))],
+               samples[count - 1]);
+    }
+    if (extra) {
+        printf(",%s", extra);
+    }
+    printf("}\n");
+    fflush(stdout);
+}
+
+static NodeList* build_cluster(const BenchConfig* config) {
+    NodeList* nodes = nl_create(config->nodes);
+    if (!nodes) {
+        return NULL;
+    }
+    nl_set_policy(nodes, config->policy);
+    
+    for (int i = 0; i < config->nodes; i++) {
+        ResourceNode* node = (ResourceNode*)malloc(sizeof(ResourceNode));
+        if (!node) {
+            return nodes; // Smaller cluster
+        }
+        node->node_id = i + 1;
+        node->total_cpu = node->available_cpu = config->node_cpu;
+        node->total_ram = node->available_ram = config->node_ram;
+        if (!nl_add(nodes, node)) {
+            free(node);
+            return nodes;
+        }
+    }
+    return nodes;
+}
+
+static void free_state(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, JobPool* pool) {
+    if (nodes) {
+        for (int i = 0; i < nodes->size; i++) {
+            free(nodes->nodes[i]);
+        }
+        nl_free(nodes);
+    }
+    pq_free(pq);
+    ht_free(running_jobs);
+    jl_free(completed_jobs);
+    jp_free(pool);
+}
+
+// pq_insert, pq_extract_min and pq_insert_batch on one queue kind
+static int bench_queue(const BenchConfig* config, QueueKind kind, long long* samples) {
+    const char* variant = pq_kind_name(kind);
+    JobPool* pool = jp_create();
+    Job** jobs = (Job**)malloc(config->jobs * sizeof(Job*));
+    PriorityQueue* pq = pq_create(16);
+    if (!pool || !jobs || !pq || !pq_set_kind(pq, kind)) {
+        jp_free(pool);
+        free(jobs);
+        pq_free(pq);
+        return 0;
+    }
+    
+    rng_seed(config->seed);
+    for (int i = 0; i < config->jobs; i++) {
+        jobs[i] = jp_alloc(pool);
+        if (!jobs[i]) {
+            jp_free(pool);
+            free(jobs);
+            pq_free(pq);
+            return 0;
+        }
+        generate_job(config, jobs[i], i + 1, i);
+    }
+    
+    long long total = 0;
+    for (int i = 0; i < config->jobs; i++) {
+        long long start = now_ns();
+        pq_insert(pq, jobs[i]);
+        samples[i] = now_ns() - start;
+        total += samples[i];
+    }
+    report("pq_insert", variant, config->jobs, total, samples, config->jobs, NULL);
+    
+    total = 0;
+    for (int i = 0; i < config->jobs; i++) {
+        long long start = now_ns();
+        pq_extract_min(pq);
+        samples[i] = now_ns() - start;
+        total += samples[i];
+    }
+    report("pq_extract_min", variant, config->jobs, total, samples, config->jobs, NULL);
+    
+    long long start = now_ns();
+    pq_insert_batch(pq, jobs, config->jobs);
+    total = now_ns() - start;
+    report("pq_insert_batch", variant, config->jobs, total, NULL, 0, NULL);
+    
+    pq_free(pq);
+    free(jobs);
+    jp_free(pool);
+    return 1;
+}
+
+// ht_insert of running jobs, then ht_remove in a shuffled order
+static int bench_hash(const BenchConfig* config, long long* samples) {
+    JobPool* pool = jp_create();
+    Job** jobs = (Job**)malloc(config->jobs * sizeof(Job*));
+    HashTable* ht = ht_create(16);
+    if (!pool || !jobs || !ht) {
+        jp_free(pool);
+        free(jobs);
+        ht_free(ht);
+        return 0;
+    }
+    
+    rng_seed(config->seed);
+    for (int i = 0; i < config->jobs; i++) {
+        jobs[i] = jp_alloc(pool);
+        if (!jobs[i]) {
+            jp_free(pool);
+            free(jobs);
+            ht_free(ht);
+            return 0;
+        }
+        generate_job(config, jobs[i], i + 1, 0);
+        jobs[i]->status = 1; // Running
+        jobs[i]->start_time = 0;
+        jobs[i]->finish_time = jobs[i]->duration;
+    }
+    
+    long long total = 0;
+    for (int i = 0; i < config->jobs; i++) {
+        long long start = now_ns();
+        ht_insert(ht, jobs[i], i % (config->nodes > 0 ? config->nodes : 1) + 1);
+        samples[i] = now_ns() - start;
+        total += samples[i];
+    }
+    report("ht_insert", "robin-hood", config->jobs, total, samples, config->jobs, NULL);
+    
+    for (int i = config->jobs - 1; i > 0; i--) {
+        int j = rng_range(0, i);
+        Job* temp = jobs[i];
+        jobs[i] = jobs[j];
+        jobs[j] = temp;
+    }
+    
+    total = 0;
+    for (int i = 0; i < config->jobs; i++) {
+        long long start = now_ns();
+        ht_remove(ht, jobs[i]->job_id);
+        samples[i] = now_ns() - start;
+        total += samples[i];
+    }
+    report("ht_remove", "robin-hood", config->jobs, total, samples, config->jobs, NULL);
+    
+    ht_free(ht);
+    free(jobs);
+    jp_free(pool);
+    return 1;
+}
+
+// nl_find_available_node under every placement policy on partly full
+// clusters of 1x, 4x and 16x --nodes nodes: a sub-linear lookup stays about
+// as fast as the cluster grows
+static int bench_placement(const BenchConfig* config, long long* samples) {
+    Job job;
+    char extra[64];
+    int lookups = config->jobs < 20000 ? config->jobs : 20000;
+    
+    for (int scale = 1; scale <= 16; scale *= 4) {
+        BenchConfig sized = *config;
+        sized.nodes = config->nodes * scale;
+        NodeList* nodes = build_cluster(&sized);
+        if (!nodes) {
+            return 0;
+        }
+        
+        // Random leftovers, so some nodes are full and some nearly empty
+        rng_seed(config->seed);
+        for (int i = 0; i < nodes->size; i++) {
+            nl_reserve(nodes, i, rng_range(0, config->node_cpu), rng_range(0, config->node_ram));
+        }
+        
+        for (int policy = PLACEMENT_FIRST_FIT; policy <= PLACEMENT_DOT_PRODUCT; policy++) {
+            nl_set_policy(nodes, (PlacementPolicy)policy);
+            rng_seed(config->seed + 1);
+            generate_job(config, &job, 0, 0);
+            nl_find_available_node(nodes, &job); // Builds any per-policy index (not timed)
+            long long total = 0;
+            for (int i = 0; i < lookups; i++) {
+                generate_job(config, &job, i + 1, 0);
+                long long start = now_ns();
+                nl_find_available_node(nodes, &job);
+                samples[i] = now_ns() - start;
+                total += samples[i];
+            }
+            snprintf(extra, sizeof(extra), "\"nodes\":%d", nodes->size);
+            report("nl_find_available_node", nl_policy_name((PlacementPolicy)policy), lookups, total,
+                   samples, lookups, extra);
+        }
+        free_state(nodes, NULL, NULL, NULL, NULL);
+    }
+    return 1;
+}
+
+// Save and load the state left by the tick benchmark, in both formats
+static void bench_persistence(const BenchConfig* config, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs,
+                              JobList* completed_jobs, int current_time, int next_job_id, const char* variant) {
+    const char* formats[] = { "snapshot", "text" };
+    char extra[128];
+    
+    for (int f = 0; f < 2; f++) {
+        long long start = now_ns();
+        int ok = f == 0 ? save_snapshot(config->state_file, nodes, pq, running_jobs, completed_jobs, current_time, next_job_id)
+                        : save_state(config->state_file, nodes, pq, running_jobs, completed_jobs, current_time, next_job_id);
+        long long elapsed = now_ns() - start;
+        if (!ok) {
+            fprintf(stderr, "Error: Failed to save %s to %s\n", formats[f], config->state_file);
+            continue;
+        }
+        
+        long bytes = 0;
+        FILE* file = fopen(config->state_file, "rb");
+        if (file) {
+            fseek(file, 0, SEEK_END);
+            bytes = ftell(file);
+            fclose(file);
+        }
+        snprintf(extra, sizeof(extra), "\"format\":\"%s\",\"bytes\":%ld", formats[f], bytes);
+        report("save_state", variant, 1, elapsed, NULL, 0, extra);
+        
+        NodeList* new_nodes = NULL;
+        PriorityQueue* new_pq = NULL;
+        HashTable* new_running_jobs = NULL;
+        JobList* new_completed_jobs = NULL;
+        JobPool* pool = jp_create();
+        int loaded_time, loaded_next_id;
+        start = now_ns();
+        ok = pool && load_state(config->state_file, &new_nodes, &new_pq, &new_running_jobs, &new_completed_jobs,
+                                pool, &loaded_time, &loaded_next_id);
+        elapsed = now_ns() - start;
+        if (ok) {
+            report("load_state", variant, 1, elapsed, NULL, 0, extra);
+            free_state(new_nodes, new_pq, new_running_jobs, new_completed_jobs, pool);
+        } else {
+            fprintf(stderr, "Error: Failed to load %s from %s\n", formats[f], config->state_file);
+            jp_free(pool);
+        }
+    }
+    remove(config->state_file);
+}
+
+// A job stream arriving evenly over config->ticks ticks on a fresh cluster:
+// per-tick latency of run_scheduler_tick, then the time to drain the rest
+static int bench_ticks(const BenchConfig* config, QueueKind kind, long long* samples) {
+    const char* variant = pq_kind_name(kind);
+    JobPool* pool = jp_create();
+    NodeList* nodes = build_cluster(config);
+    PriorityQueue* pq = pq_create(16);
+    HashTable* running_jobs = ht_create(16);
+    JobList* completed_jobs = pool ? jl_create(pool) : NULL;
+    Scheduler* sched = scheduler_create();
+    if (!pool || !nodes || !pq || !running_jobs || !completed_jobs || !sched || !pq_set_kind(pq, kind) ||
+        !scheduler_set_threads(sched, config->threads)) {
+        free_state(nodes, pq, running_jobs, completed_jobs, pool);
+        scheduler_free(sched);
+        return 0;
+    }
+    jl_set_retention(completed_jobs, 1000); // Keep memory flat: history is not measured
+    
+    rng_seed(config->seed);
+    int next_job_id = 1;
+    int current_time = 0;
+    long long total = 0;
+    for (int tick = 0; tick < config->ticks; tick++) {
+        // Jobs arriving before this tick (not timed)
+        int due = (int)((long long)config->jobs * (tick + 1) / config->ticks);
+        while (next_job_id <= due) {
+            Job* job = jp_alloc(pool);
+            if (!job) {
+                break;
+            }
+            generate_job(config, job, next_job_id++, current_time);
+            pq_insert(pq, job);
+        }
+        
+        long long start = now_ns();
+        run_scheduler_tick(sched, nodes, pq, running_jobs, completed_jobs, ++current_time);
+        samples[tick] = now_ns() - start;
+        total += samples[tick];
+    }
+    
+    char extra[128];
+    snprintf(extra, sizeof(extra), "\"nodes\":%d,\"jobs\":%d,\"completed\":%lld,\"running\":%d,\"pending\":%d",
+             nodes->size, config->jobs, jl_total(completed_jobs), ht_size(running_jobs), pq_size(pq));
+    report("run_scheduler_tick", variant, config->ticks, total, samples, config->ticks, extra);
+    
+    bench_persistence(config, nodes, pq, running_jobs, completed_jobs, current_time, next_job_id, variant);
+    
+    long long completed_before = jl_total(completed_jobs);
+    long long start = now_ns();
+    int passes = run_scheduler_until(sched, nodes, pq, running_jobs, completed_jobs, &current_time, INT_MAX, 1);
+    total = now_ns() - start;
+    snprintf(extra, sizeof(extra), "\"passes\":%d,\"completed\":%lld,\"pending\":%d,\"makespan\":%d",
+             passes, jl_total(completed_jobs), pq_size(pq), current_time);
+    report("run_until_idle", variant, jl_total(completed_jobs) - completed_before, total, NULL, 0, extra);
+    
+    free_state(nodes, pq, running_jobs, completed_jobs, pool);
+    scheduler_free(sched);
+    return 1;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [--nodes <n>] [--node-cpu <n>] [--node-ram <n>] [--jobs <n>] [--ticks <n>]\n"
+            "          [--max-priority <n>] [--max-cpu <n>] [--max-ram <n>] [--max-duration <n>]\n"
+            "          [--threads <n>] [--seed <n>] [--queue <heap|bucket|all>] [--policy <policy>] [--state-file <path>]\n",
+            program);
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    config.nodes = 1000;
+    config.node_cpu = 64;
+    config.node_ram = 256;
+    config.jobs = 200000;
+    config.ticks = 250;     // About twice what the cluster can run, so a backlog forms
+    config.max_priority = 9;
+    config.max_cpu = 64;
+    config.max_ram = 256;
+    config.max_duration = 20;
+    config.threads = 1;
+    config.seed = 1;
+    config.queue = "all";
+    config.policy = PLACEMENT_FIRST_FIT;
+    config.state_file = "bench_state.tmp";
+    
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        int* target = NULL;
+        if (strcmp(argv[i], "--nodes") == 0) target = &config.nodes;
+        else if (strcmp(argv[i], "--node-cpu") == 0) target = &config.node_cpu;
+        else if (strcmp(argv[i], "--node-ram") == 0) target = &config.node_ram;
+        else if (strcmp(argv[i], "--jobs") == 0) target = &config.jobs;
+        else if (strcmp(argv[i], "--ticks") == 0) target = &config.ticks;
+        else if (strcmp(argv[i], "--max-priority") == 0) target = &config.max_priority;
+        else if (strcmp(argv[i], "--max-cpu") == 0) target = &config.max_cpu;
+        else if (strcmp(argv[i], "--max-ram") == 0) target = &config.max_ram;
+        else if (strcmp(argv[i], "--max-duration") == 0) target = &config.max_duration;
+        else if (strcmp(argv[i], "--threads") == 0) target = &config.threads;
+        
+        if (!value) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (target) {
+            *target = atoi(value);
+            if (*target <= 0 && target != &config.max_priority) {
+                fprintf(stderr, "Error: %s must be positive\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            config.seed = strtoull(value, NULL, 10);
+        } else if (strcmp(argv[i], "--queue") == 0) {
+            config.queue = value;
+        } else if (strcmp(argv[i], "--policy") == 0) {
+            if (!nl_parse_policy(value, &config.policy)) {
+                fprintf(stderr, "Error: Unknown placement policy %s\n", value);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--state-file") == 0) {
+            config.state_file = value;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (config.max_priority < 0) {
+        fprintf(stderr, "Error: --max-priority must be non-negative\n");
+        return 1;
+    }
+    if (config.max_cpu > config.node_cpu || config.max_ram > config.node_ram) {
+        fprintf(stderr, "Error: jobs may need more than a node has (--max-cpu/--max-ram above --node-cpu/--node-ram)\n");
+        return 1;
+    }
+    
+    QueueKind kinds[2];
+    int kind_count = 0;
+    if (strcmp(config.queue, "all") == 0) {
+        kinds[kind_count++] = PQ_KIND_HEAP;
+        kinds[kind_count++] = PQ_KIND_BUCKET;
+    } else if (pq_parse_kind(config.queue, &kinds[0])) {
+        kind_count = 1;
+    } else {
+        fprintf(stderr, "Error: Unknown queue kind %s\n", config.queue);
+        return 1;
+    }
+    
+    int sample_count = config.jobs > config.ticks ? config.jobs : config.ticks;
+    long long* samples = (long long*)malloc(sample_count * sizeof(long long));
+    if (!samples) {
+        fprintf(stderr, "Error: Failed to allocate memory for samples\n");
+        return 1;
+    }
+    
+    int ok = 1;
+    for (int k = 0; k < kind_count; k++) {
+        ok = bench_queue(&config, kinds[k], samples) && ok;
+    }
+    ok = bench_hash(&config, samples) && ok;
+    ok = bench_placement(&config, samples) && ok;
+    for (int k = 0; k < kind_count; k++) {
+        ok = bench_ticks(&config, kinds[k], samples) && ok;
+    }
+    
+    free(samples);
+    if (!ok) {
+        fprintf(stderr, "Error: Some benchmarks could not run (out of memory)\n");
+        return 1;
+    }
+    return 0;
+}
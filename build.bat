@@ -22,15 +22,24 @@ if %ERRORLEVEL% NEQ 0 (
 echo Compiling source files...
 echo.
 
-REM Compile all source files
-gcc -Wall -Wextra -std=c11 -g -o scheduler.exe ^
+REM Compile all source files (single-threaded completion drain; build with
+REM Makefile.windows for worker threads)
+gcc -Wall -Wextra -std=c11 -g -DSCHED_METRICS -o scheduler.exe ^
     main.c ^
     priority_queue.c ^
     hash_table.c ^
     node_list.c ^
     job_list.c ^
     scheduler.c ^
-    persistence.c
+    persistence.c ^
+    job_pool.c ^
+    journal.c ^
+    submit_queue.c ^
+    metrics.c ^
+    histogram.c ^
+    trace.c ^
+    replay.c ^
+    worker_pool.c
 
 if %ERRORLEVEL% EQU 0 (
     echo.
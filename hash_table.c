@@ -1,30 +1,250 @@
 #include "hash_table.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+// Grow once the table is more than 7/8 full; Robin Hood probing keeps probe
+// sequences short even at high load
+#define HT_MAX_LOAD_NUM 7
+#define HT_MAX_LOAD_DEN 8
+
+static int round_up_pow2(int n) {
+    int capacity = 1;
+    while (capacity < n) {
+        capacity *= 2;
+    }
+    return capacity;
+}
 
 HashTable* ht_create(int size) {
     if (size <= 0) {
         size = 16; // Default size
     }
+    size = round_up_pow2(size);
     
     HashTable* ht = (HashTable*)malloc(sizeof(HashTable));
     if (!ht) {
         return NULL;
     }
     
-    ht->table = (HashNode**)calloc(size, sizeof(HashNode*));
+    ht->table = (HashNode*)calloc(size, sizeof(HashNode));
     if (!ht->table) {
         free(ht);
         return NULL;
     }
     
-    ht->size = size;
+    // Every shard starts with room in its due buffer, so a drain always
+    // makes progress even if the buffers cannot grow later
+    int shard_size = size / HT_EVENT_SHARDS > 4 ? size / HT_EVENT_SHARDS : 4;
+    int ok = 1;
+    for (int s = 0; s < HT_EVENT_SHARDS; s++) {
+        EventShard* shard = &ht->shards[s];
+        shard->events = (CompletionEvent*)malloc(shard_size * sizeof(CompletionEvent));
+        shard->due = (CompletionEvent*)malloc(shard_size * sizeof(CompletionEvent));
+        shard->count = 0;
+        shard->capacity = shard->events ? shard_size : 0;
+        shard->due_count = 0;
+        shard->due_capacity = shard->due ? shard_size : 0;
+        shard->truncated = 0;
+        ok = ok && shard->events && shard->due;
+    }
+    ht->finished = (FinishedJob*)malloc(size * sizeof(FinishedJob));
+    ht->capacity = size;
+    ht->count = 0;
+    ht->finished_capacity = size;
+    if (!ok || !ht->finished) {
+        ht_free(ht);
+        return NULL;
+    }
     return ht;
 }
 
 unsigned int hash(int job_id, int table_size) {
-    // Simple hash function
-    return (unsigned int)(job_id % table_size);
+    // Mix the bits (murmur3 finalizer) so sequential ids spread over the
+    // table, then mask; table_size must be a power of two
+    unsigned int h = (unsigned int)job_id;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h & (unsigned int)(table_size - 1);
+}
+
+// Place an entry that is known not to be in the table (Robin Hood insertion:
+// an entry that has probed further than the resident takes its slot)
+static void table_place(HashNode* table, int capacity, HashNode entry) {
+    int mask = capacity - 1;
+    int index = (int)hash(entry.job_id, capacity);
+    entry.distance = 0;
+    
+    while (table[index].job) {
+        if (table[index].distance < entry.distance) {
+            HashNode displaced = table[index];
+            table[index] = entry;
+            entry = displaced;
+        }
+        index = (index + 1) & mask;
+        entry.distance++;
+    }
+    table[index] = entry;
+}
+
+static int ht_resize(HashTable* ht) {
+    int new_capacity = ht->capacity * 2;
+    HashNode* new_table = (HashNode*)calloc(new_capacity, sizeof(HashNode));
+    if (!new_table) {
+        return 0; // Failed to resize
+    }
+    
+    for (int i = 0; i < ht->capacity; i++) {
+        if (ht->table[i].job) {
+            table_place(new_table, new_capacity, ht->table[i]);
+        }
+    }
+    
+    free(ht->table);
+    ht->table = new_table;
+    ht->capacity = new_capacity;
+    return 1;
+}
+
+// Slot index holding job_id, or -1
+static int table_lookup(HashTable* ht, int job_id) {
+    int mask = ht->capacity - 1;
+    int index = (int)hash(job_id, ht->capacity);
+    
+    // Entries are ordered by probe distance, so the search can stop as soon
+    // as a resident is closer to its home slot than the key would be
+    for (int distance = 0; ht->table[index].job && ht->table[index].distance >= distance; distance++) {
+        if (ht->table[index].job_id == job_id) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+    return -1; // Not found
+}
+
+// Ordering of completion events: earliest finish time first, job_id breaks ties
+static int event_before(const CompletionEvent* a, const CompletionEvent* b) {
+    if (a->finish_time != b->finish_time) {
+        return a->finish_time < b->finish_time;
+    }
+    return a->job_id < b->job_id;
+}
+
+static EventShard* shard_of(HashTable* ht, int job_id) {
+    return &ht->shards[(unsigned int)job_id % HT_EVENT_SHARDS];
+}
+
+static void event_swap(EventShard* shard, int i, int j) {
+    CompletionEvent temp = shard->events[i];
+    shard->events[i] = shard->events[j];
+    shard->events[j] = temp;
+}
+
+static int shard_push(EventShard* shard, CompletionEvent event) {
+    if (shard->count >= shard->capacity) {
+        int new_capacity = shard->capacity ? shard->capacity * 2 : 4;
+        CompletionEvent* new_events = (CompletionEvent*)realloc(shard->events, new_capacity * sizeof(CompletionEvent));
+        if (!new_events) {
+            return 0; // Failed to resize
+        }
+        shard->events = new_events;
+        shard->capacity = new_capacity;
+    }
+    
+    int index = shard->count++;
+    shard->events[index] = event;
+    
+    // Sift up
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!event_before(&shard->events[index], &shard->events[parent])) {
+            break;
+        }
+        event_swap(shard, index, parent);
+        index = parent;
+    }
+    return 1;
+}
+
+static int event_push(HashTable* ht, int finish_time, int job_id, int node_id) {
+    CompletionEvent event;
+    event.finish_time = finish_time;
+    event.job_id = job_id;
+    event.node_id = node_id;
+    return shard_push(shard_of(ht, job_id), event);
+}
+
+static void shard_sift_down(EventShard* shard, int index) {
+    while (1) {
+        int left = 2 * index + 1;
+        int right = 2 * index + 2;
+        int smallest = index;
+        if (left < shard->count && event_before(&shard->events[left], &shard->events[smallest])) {
+            smallest = left;
+        }
+        if (right < shard->count && event_before(&shard->events[right], &shard->events[smallest])) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        event_swap(shard, index, smallest);
+        index = smallest;
+    }
+}
+
+static void shard_pop(EventShard* shard) {
+    shard->events[0] = shard->events[--shard->count];
+    shard_sift_down(shard, 0);
+}
+
+static int event_compare(const void* a, const void* b) {
+    const CompletionEvent* x = (const CompletionEvent*)a;
+    const CompletionEvent* y = (const CompletionEvent*)b;
+    if (event_before(x, y)) return -1;
+    if (event_before(y, x)) return 1;
+    return 0;
+}
+
+// Count events finishing by current_time in the subtree rooted at index,
+// stopping early once limit is reached
+static int shard_count_due(EventShard* shard, int index, int current_time, int limit) {
+    if (limit <= 0 || index >= shard->count || shard->events[index].finish_time > current_time) {
+        return 0;
+    }
+    int count = 1;
+    count += shard_count_due(shard, 2 * index + 1, current_time, limit - count);
+    count += shard_count_due(shard, 2 * index + 2, current_time, limit - count);
+    return count;
+}
+
+// Drop events at the top of a shard whose job is no longer in the table
+// (removed with ht_remove, or re-inserted with a different finish time)
+static void shard_discard_stale(HashTable* ht, EventShard* shard) {
+    while (shard->count > 0) {
+        CompletionEvent* top = &shard->events[0];
+        HashNode* entry = ht_find(ht, top->job_id);
+        if (entry && entry->job->finish_time == top->finish_time) {
+            return;
+        }
+        shard_pop(shard);
+    }
+}
+
+// Shard whose (non-stale) top event comes first, or NULL if none has events
+static EventShard* earliest_shard(HashTable* ht) {
+    EventShard* earliest = NULL;
+    for (int s = 0; s < HT_EVENT_SHARDS; s++) {
+        EventShard* shard = &ht->shards[s];
+        shard_discard_stale(ht, shard);
+        if (shard->count > 0 && (!earliest || event_before(&shard->events[0], &earliest->events[0]))) {
+            earliest = shard;
+        }
+    }
+    return earliest;
 }
 
 int ht_insert(HashTable* ht, Job* job, int node_id) {
@@ -32,31 +252,37 @@ int ht_insert(HashTable* ht, Job* job, int node_id) {
         return 0; // Error
     }
     
-    unsigned int index = hash(job->job_id, ht->size);
+    // Jobs without a finish time (pending jobs) are only indexed by id
+    int track = job->finish_time >= 0;
     
     // Check if job already exists
-    HashNode* current = ht->table[index];
-    while (current) {
-        if (current->job_id == job->job_id) {
-            // Update existing entry
-            current->job = job;
-            current->node_id = node_id;
-            return 1; // Success
-        }
-        current = current->next;
+    int index = table_lookup(ht, job->job_id);
+    if (index != -1) {
+        // Update existing entry
+        ht->table[index].job = job;
+        ht->table[index].node_id = node_id;
+        return !track || event_push(ht, job->finish_time, job->job_id, node_id);
     }
     
-    // Create new hash node
-    HashNode* new_node = (HashNode*)malloc(sizeof(HashNode));
-    if (!new_node) {
-        return 0; // Failed to allocate
+    // Track completion first so a failure leaves the table unchanged
+    if (track && !event_push(ht, job->finish_time, job->job_id, node_id)) {
+        return 0; // Failed to track completion
+    }
+    
+    // Resize if necessary
+    if ((ht->count + 1) * HT_MAX_LOAD_DEN > ht->capacity * HT_MAX_LOAD_NUM) {
+        if (!ht_resize(ht)) {
+            return 0; // Failed to resize (the event is discarded as stale)
+        }
     }
     
-    new_node->job_id = job->job_id;
-    new_node->job = job;
-    new_node->node_id = node_id;
-    new_node->next = ht->table[index];
-    ht->table[index] = new_node;
+    HashNode entry;
+    entry.job_id = job->job_id;
+    entry.job = job;
+    entry.node_id = node_id;
+    entry.distance = 0;
+    table_place(ht->table, ht->capacity, entry);
+    ht->count++;
     
     return 1; // Success
 }
@@ -66,17 +292,29 @@ HashNode* ht_find(HashTable* ht, int job_id) {
         return NULL;
     }
     
-    unsigned int index = hash(job_id, ht->size);
-    HashNode* current = ht->table[index];
+    int index = table_lookup(ht, job_id);
+    return index != -1 ? &ht->table[index] : NULL;
+}
+
+// Remove the entry in the given slot and return its job
+static Job* table_remove_at(HashTable* ht, int index) {
+    Job* job = ht->table[index].job;
     
-    while (current) {
-        if (current->job_id == job_id) {
-            return current;
-        }
-        current = current->next;
+    // Backward-shift deletion: pull the following entries of the probe run
+    // one slot closer to home instead of leaving a tombstone
+    int mask = ht->capacity - 1;
+    int next = (index + 1) & mask;
+    while (ht->table[next].job && ht->table[next].distance > 0) {
+        ht->table[index] = ht->table[next];
+        ht->table[index].distance--;
+        index = next;
+        next = (next + 1) & mask;
     }
+    ht->table[index].job = NULL;
+    ht->table[index].distance = 0;
+    ht->count--;
     
-    return NULL; // Not found
+    return job;
 }
 
 Job* ht_remove(HashTable* ht, int job_id) {
@@ -84,75 +322,413 @@ Job* ht_remove(HashTable* ht, int job_id) {
         return NULL;
     }
     
-    unsigned int index = hash(job_id, ht->size);
-    HashNode* current = ht->table[index];
-    HashNode* prev = NULL;
+    int index = table_lookup(ht, job_id);
+    if (index == -1) {
+        return NULL; // Not found
+    }
+    
+    return table_remove_at(ht, index);
+}
+
+int ht_next_finish_time(HashTable* ht) {
+    if (!ht) {
+        return -1;
+    }
+    
+    EventShard* shard = earliest_shard(ht);
+    return shard ? shard->events[0].finish_time : -1;
+}
+
+Job* ht_pop_finished(HashTable* ht, int current_time, int* node_id) {
+    if (!ht) {
+        return NULL;
+    }
+    
+    EventShard* shard = earliest_shard(ht);
+    if (!shard || shard->events[0].finish_time > current_time) {
+        return NULL; // Nothing finishes by current_time
+    }
+    
+    CompletionEvent event = shard->events[0];
+    shard_pop(shard);
+    
+    if (node_id) {
+        *node_id = event.node_id;
+    }
+    return ht_remove(ht, event.job_id);
+}
+
+static int due_reserve(EventShard* shard, int count) {
+    if (count <= shard->due_capacity) {
+        return 1;
+    }
+    int new_capacity = shard->due_capacity ? shard->due_capacity : 4;
+    while (new_capacity < count) {
+        new_capacity *= 2;
+    }
+    CompletionEvent* new_due = (CompletionEvent*)realloc(shard->due, new_capacity * sizeof(CompletionEvent));
+    if (!new_due) {
+        return 0;
+    }
+    shard->due = new_due;
+    shard->due_capacity = new_capacity;
+    return 1;
+}
+
+// Move a shard's events due by current_time into its due buffer, in
+// (finish_time, job_id) order. Only the shard is touched (stale events are
+// left for the merge to drop), so different shards can be collected by
+// different threads at once. If the buffer cannot grow, only the earliest
+// due events are taken and the shard is marked truncated
+static void shard_collect_due(EventShard* shard, int current_time) {
+    shard->due_count = 0;
+    shard->truncated = 0;
+    
+    // Popping k due events costs O(k log n); partitioning the whole heap
+    // costs O(n + k log k), which wins once about n / log n are due
+    int n = shard->count;
+    int depth = 1;
+    while (depth < 31 && (1 << depth) < n) {
+        depth++;
+    }
+    int threshold = n / depth;
+    int due = shard_count_due(shard, 0, current_time, threshold);
     
-    while (current) {
-        if (current->job_id == job_id) {
-            // Remove this node
-            if (prev) {
-                prev->next = current->next;
-            } else {
-                ht->table[index] = current->next;
+    if (due < threshold || due == 0) {
+        // Few due events (due is exact): pop them one at a time
+        due_reserve(shard, due);
+        while (shard->count > 0 && shard->events[0].finish_time <= current_time) {
+            if (shard->due_count == shard->due_capacity) {
+                shard->truncated = 1;
+                break;
             }
-            
-            Job* job = current->job;
-            free(current);
-            return job;
+            shard->due[shard->due_count++] = shard->events[0];
+            shard_pop(shard);
+        }
+        return;
+    }
+    
+    // Move every due event to the tail of the array and sort just those
+    int low = 0;
+    int high = n;
+    while (low < high) {
+        if (shard->events[low].finish_time <= current_time) {
+            event_swap(shard, low, --high);
+        } else {
+            low++;
         }
-        prev = current;
-        current = current->next;
     }
+    due = n - low;
+    qsort(&shard->events[low], due, sizeof(CompletionEvent), event_compare);
     
-    return NULL; // Not found
+    // Take as many as the buffer holds
+    int taken = due;
+    if (!due_reserve(shard, due) && taken > shard->due_capacity) {
+        taken = shard->due_capacity;
+        shard->truncated = 1;
+    }
+    memcpy(shard->due, &shard->events[low], taken * sizeof(CompletionEvent));
+    shard->due_count = taken;
+    
+    // Keep any events not taken and restore the heap order
+    memmove(&shard->events[low], &shard->events[low + taken], (due - taken) * sizeof(CompletionEvent));
+    shard->count = n - taken;
+    for (int i = shard->count / 2 - 1; i >= 0; i--) {
+        shard_sift_down(shard, i);
+    }
 }
 
-int ht_size(HashTable* ht) {
-    if (!ht) {
+typedef struct {
+    HashTable* ht;
+    int current_time;
+    int shards[HT_EVENT_SHARDS];    // Shards with an event due
+    int count;
+} CollectBatch;
+
+static void collect_task(int index, void* arg) {
+    CollectBatch* batch = (CollectBatch*)arg;
+    shard_collect_due(&batch->ht->shards[batch->shards[index]], batch->current_time);
+}
+
+// Whether shard a's next due event comes before shard b's (merge heap order)
+static int merge_before(HashTable* ht, const int* next, int a, int b) {
+    return event_before(&ht->shards[a].due[next[a]], &ht->shards[b].due[next[b]]);
+}
+
+static void merge_sift_down(HashTable* ht, const int* next, int* heap, int size, int index) {
+    while (1) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = 2 * index + 2;
+        if (left < size && merge_before(ht, next, heap[left], heap[smallest])) {
+            smallest = left;
+        }
+        if (right < size && merge_before(ht, next, heap[right], heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        int temp = heap[index];
+        heap[index] = heap[smallest];
+        heap[smallest] = temp;
+        index = smallest;
+    }
+}
+
+static int finished_reserve(HashTable* ht, int count) {
+    if (count <= ht->finished_capacity) {
+        return 1;
+    }
+    int new_capacity = ht->finished_capacity;
+    while (new_capacity < count) {
+        new_capacity *= 2;
+    }
+    FinishedJob* new_finished = (FinishedJob*)realloc(ht->finished, new_capacity * sizeof(FinishedJob));
+    if (!new_finished) {
+        return 0;
+    }
+    ht->finished = new_finished;
+    ht->finished_capacity = new_capacity;
+    return 1;
+}
+
+int ht_drain_finished(HashTable* ht, int current_time, WorkerPool* workers, FinishedJob** finished) {
+    if (!ht || !finished) {
         return 0;
     }
+    *finished = ht->finished;
+    
+    // Collect the due events of each shard that has any (on the worker
+    // threads, if there is more than one such shard); a tick on which
+    // nothing finishes does not wake the workers at all
+    CollectBatch batch;
+    batch.ht = ht;
+    batch.current_time = current_time;
+    batch.count = 0;
+    for (int s = 0; s < HT_EVENT_SHARDS; s++) {
+        EventShard* shard = &ht->shards[s];
+        if (shard->count > 0 && shard->events[0].finish_time <= current_time) {
+            batch.shards[batch.count++] = s;
+        }
+    }
+    if (batch.count == 0) {
+        return 0;
+    }
+    wp_run(batch.count > 1 ? workers : NULL, batch.count, collect_task, &batch);
+    
+    // A truncated shard still holds due events, so nothing at or after the
+    // earliest of them may be completed yet
+    const CompletionEvent* cutoff = NULL;
+    int total = 0;
+    for (int i = 0; i < batch.count; i++) {
+        EventShard* shard = &ht->shards[batch.shards[i]];
+        total += shard->due_count;
+        if (shard->truncated && shard->count > 0 &&
+            (!cutoff || event_before(&shard->events[0], cutoff))) {
+            cutoff = &shard->events[0];
+        }
+    }
+    int limit = total;
+    if (!finished_reserve(ht, total) && limit > ht->finished_capacity) {
+        limit = ht->finished_capacity;
+    }
+    *finished = ht->finished;
+    
+    // Merge the shards in (finish_time, job_id) order through a heap of
+    // shards keyed by their next due event, dropping stale events; a
+    // duplicate event of a job finds it already removed
+    int next[HT_EVENT_SHARDS] = { 0 };
+    int heap[HT_EVENT_SHARDS];
+    int heap_size = 0;
+    for (int i = 0; i < batch.count; i++) {
+        if (ht->shards[batch.shards[i]].due_count > 0) {
+            heap[heap_size++] = batch.shards[i];
+        }
+    }
+    for (int i = heap_size / 2 - 1; i >= 0; i--) {
+        merge_sift_down(ht, next, heap, heap_size, i);
+    }
     
     int count = 0;
-    for (int i = 0; i < ht->size; i++) {
-        HashNode* current = ht->table[i];
-        while (current) {
-            count++;
-            current = current->next;
+    int taken = 0;
+    while (taken < limit && heap_size > 0) {
+        int s = heap[0];
+        EventShard* earliest = &ht->shards[s];
+        CompletionEvent* event = &earliest->due[next[s]];
+        if (cutoff && !event_before(event, cutoff)) {
+            break;
+        }
+        if (++next[s] == earliest->due_count) {
+            heap[0] = heap[--heap_size]; // Shard used up
+        }
+        merge_sift_down(ht, next, heap, heap_size, 0);
+        taken++;
+        
+        int index = table_lookup(ht, event->job_id);
+        if (index == -1 || ht->table[index].job->finish_time != event->finish_time) {
+            continue; // Stale
+        }
+        ht->finished[count].node_id = ht->table[index].node_id;
+        ht->finished[count].job = table_remove_at(ht, index);
+        count++;
+    }
+    
+    // Events collected but not completed go back to their shards (which
+    // they just left, so there is room)
+    for (int i = 0; i < batch.count; i++) {
+        int s = batch.shards[i];
+        EventShard* shard = &ht->shards[s];
+        for (int j = next[s]; j < shard->due_count; j++) {
+            shard_push(shard, shard->due[j]);
         }
+        shard->due_count = 0;
+        shard->truncated = 0;
     }
     return count;
 }
 
+int ht_size(HashTable* ht) {
+    return ht ? ht->count : 0;
+}
+
 void ht_traverse(HashTable* ht, ht_traverse_callback callback, void* user_data) {
     if (!ht || !callback) {
         return;
     }
     
-    for (int i = 0; i < ht->size; i++) {
-        HashNode* current = ht->table[i];
-        while (current) {
-            callback(current->job, current->node_id, user_data);
-            current = current->next;
+    for (int i = 0; i < ht->capacity; i++) {
+        if (ht->table[i].job) {
+            callback(ht->table[i].job, ht->table[i].node_id, user_data);
         }
     }
 }
 
-void ht_free(HashTable* ht) {
+// Frontier of the finish-order iterator: a small min-heap of event
+// positions, each encoding a shard and a heap index within it
+static const CompletionEvent* iter_event(HTFinishIterator* it, int position) {
+    return &it->ht->shards[position % HT_EVENT_SHARDS].events[position / HT_EVENT_SHARDS];
+}
+
+static int finish_iter_push(HTFinishIterator* it, int position) {
+    if (it->count >= it->capacity) {
+        int new_capacity = it->capacity * 2;
+        if (new_capacity == 0) new_capacity = 16;
+        int* new_frontier = (int*)realloc(it->frontier, new_capacity * sizeof(int));
+        if (!new_frontier) {
+            return 0; // Failed to resize
+        }
+        it->frontier = new_frontier;
+        it->capacity = new_capacity;
+    }
+    
+    int pos = it->count++;
+    it->frontier[pos] = position;
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!event_before(iter_event(it, it->frontier[pos]), iter_event(it, it->frontier[parent]))) {
+            break;
+        }
+        int temp = it->frontier[pos];
+        it->frontier[pos] = it->frontier[parent];
+        it->frontier[parent] = temp;
+        pos = parent;
+    }
+    return 1;
+}
+
+static int finish_iter_pop(HTFinishIterator* it) {
+    int top = it->frontier[0];
+    it->frontier[0] = it->frontier[--it->count];
+    
+    int pos = 0;
+    while (1) {
+        int left = 2 * pos + 1;
+        int right = 2 * pos + 2;
+        int smallest = pos;
+        if (left < it->count && event_before(iter_event(it, it->frontier[left]), iter_event(it, it->frontier[smallest]))) {
+            smallest = left;
+        }
+        if (right < it->count && event_before(iter_event(it, it->frontier[right]), iter_event(it, it->frontier[smallest]))) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            break;
+        }
+        int temp = it->frontier[pos];
+        it->frontier[pos] = it->frontier[smallest];
+        it->frontier[smallest] = temp;
+        pos = smallest;
+    }
+    return top;
+}
+
+void ht_finish_iter_init(HTFinishIterator* it, HashTable* ht) {
+    it->ht = ht;
+    it->frontier = NULL;
+    it->count = 0;
+    it->capacity = 0;
+    it->failed = 0;
     if (!ht) {
         return;
     }
     
-    for (int i = 0; i < ht->size; i++) {
-        HashNode* current = ht->table[i];
-        while (current) {
-            HashNode* next = current->next;
-            free(current);
-            current = next;
+    // Start from the root of every shard's heap
+    for (int s = 0; s < HT_EVENT_SHARDS; s++) {
+        if (ht->shards[s].count > 0 && !finish_iter_push(it, s)) {
+            it->failed = 1;
+        }
+    }
+}
+
+Job* ht_finish_iter_next(HTFinishIterator* it, int* node_id) {
+    if (!it) {
+        return NULL;
+    }
+    
+    // Walk the completion heaps in order without popping them; stale events
+    // (jobs removed or re-inserted since) are skipped
+    while (it->count > 0) {
+        int position = finish_iter_pop(it);
+        int s = position % HT_EVENT_SHARDS;
+        int index = position / HT_EVENT_SHARDS;
+        int left = 2 * index + 1;
+        int right = 2 * index + 2;
+        int shard_count = it->ht->shards[s].count;
+        if (left < shard_count && !finish_iter_push(it, left * HT_EVENT_SHARDS + s)) it->failed = 1;
+        if (right < shard_count && !finish_iter_push(it, right * HT_EVENT_SHARDS + s)) it->failed = 1;
+        
+        const CompletionEvent* event = iter_event(it, position);
+        HashNode* entry = ht_find(it->ht, event->job_id);
+        if (entry && entry->job->finish_time == event->finish_time) {
+            if (node_id) {
+                *node_id = event->node_id;
+            }
+            return entry->job;
         }
     }
+    return NULL;
+}
+
+void ht_finish_iter_free(HTFinishIterator* it) {
+    if (it) {
+        free(it->frontier);
+        it->frontier = NULL;
+        it->count = 0;
+        it->capacity = 0;
+    }
+}
+
+void ht_free(HashTable* ht) {
+    if (!ht) {
+        return;
+    }
     
+    for (int s = 0; s < HT_EVENT_SHARDS; s++) {
+        free(ht->shards[s].events);
+        free(ht->shards[s].due);
+    }
+    free(ht->finished);
     free(ht->table);
     free(ht);
 }
-
@@ -2,25 +2,68 @@
 #define HASH_TABLE_H
 
 #include "structs.h"
+#include "worker_pool.h"
 
-// Create a new hash table with specified size
+// Non-destructive iterator over running jobs in finish order (earliest
+// first, ties by job_id). Visiting k jobs costs O(k log k); the table must
+// not be modified while iterating
+typedef struct {
+    HashTable* ht;
+    int* frontier;      // Min-heap of event indices still to visit
+    int count;
+    int capacity;
+    int failed;         // Set if the frontier could not grow (jobs were skipped)
+} HTFinishIterator;
+
+// Create a new hash table with at least the specified number of slots
+// The table grows automatically as jobs are inserted
 HashTable* ht_create(int size);
 
-// Hash function for job_id
+// Hash function for job_id (table_size must be a power of two)
 unsigned int hash(int job_id, int table_size);
 
 // Insert a job into the hash table
+// A job with a finish_time is ordered by it for ht_pop_finished; a job with
+// finish_time < 0 (pending) is only indexed by id
 int ht_insert(HashTable* ht, Job* job, int node_id);
 
 // Find a job in the hash table by job_id
+// The returned entry is only valid until the next insert or remove
 HashNode* ht_find(HashTable* ht, int job_id);
 
 // Remove a job from the hash table by job_id
 Job* ht_remove(HashTable* ht, int job_id);
 
-// Get the size of the hash table
+// Earliest finish time among running jobs, or -1 if the table is empty
+int ht_next_finish_time(HashTable* ht);
+
+// Remove and return the running job with the earliest finish time if it
+// finishes at or before current_time (ties broken by job_id), else NULL.
+// The node the job ran on is stored in *node_id.
+Job* ht_pop_finished(HashTable* ht, int current_time, int* node_id);
+
+// Remove every running job that finishes at or before current_time, in the
+// order repeated ht_pop_finished calls would return them. The due events of
+// each shard are collected on the workers' threads (NULL = on the caller)
+// and merged on the caller, so the result is the same for any pool.
+// *finished points to a buffer owned by the table, valid until the next
+// call; returns the number of jobs in it. If a buffer cannot grow, only a
+// prefix is drained, so callers loop until it returns 0
+int ht_drain_finished(HashTable* ht, int current_time, WorkerPool* workers, FinishedJob** finished);
+
+// Get the number of jobs in the hash table (O(1))
 int ht_size(HashTable* ht);
 
+// Start iterating over running jobs in finish order
+void ht_finish_iter_init(HTFinishIterator* it, HashTable* ht);
+
+// Next running job in finish order (its node is stored in *node_id), or
+// NULL when done
+Job* ht_finish_iter_next(HTFinishIterator* it, int* node_id);
+
+// Release the iterator's memory
+void ht_finish_iter_free(HTFinishIterator* it);
+
 // Free the hash table (does not free jobs themselves)
 void ht_free(HashTable* ht);
 
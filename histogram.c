@@ -0,0 +1,191 @@
+#include "histogram.h"
+#include <stdio.h>
+#include <string.h>
+
+void hist_reset(Histogram* h) {
+    memset(h, 0, sizeof(*h));
+}
+
+// Position of the highest set bit (value > 0)
+static int highest_bit(unsigned int value) {
+    int bit = 0;
+    while (value >>= 1) {
+        bit++;
+    }
+    return bit;
+}
+
+// Bucket of a value: below 2 * HISTOGRAM_SUB_BUCKETS the value itself;
+// above, the power of two it falls in picks a shift that leaves its top
+// HISTOGRAM_SUB_BUCKET_BITS + 1 bits, which index the sub-bucket
+static int bucket_index(int value) {
+    if (value < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return value;
+    }
+    int shift = highest_bit((unsigned int)value) - HISTOGRAM_SUB_BUCKET_BITS;
+    return shift * HISTOGRAM_SUB_BUCKETS + (value >> shift);
+}
+
+// Highest value that falls in a bucket
+static long long bucket_highest(int index) {
+    if (index < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+    int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+    long long sub_bucket = index - shift * HISTOGRAM_SUB_BUCKETS;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+void hist_record(Histogram* h, int value) {
+    if (value < 0) {
+        value = 0;
+    }
+    
+    if (h->count == 0 || value < h->min) {
+        h->min = value;
+    }
+    if (h->count == 0 || value > h->max) {
+        h->max = value;
+    }
+    h->count++;
+    h->sum += value;
+    h->buckets[bucket_index(value)]++;
+}
+
+// Lowest value that falls in a bucket
+static int bucket_lowest(int index) {
+    if (index < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+    int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+    return (index - shift * HISTOGRAM_SUB_BUCKETS) << shift;
+}
+
+void hist_subtract(Histogram* h, const Histogram* earlier) {
+    if (earlier->count == 0) {
+        return; // Nothing to remove: min and max stay exact
+    }
+    
+    h->count -= earlier->count;
+    h->sum -= earlier->sum;
+    int first = -1, last = -1;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        h->buckets[i] -= earlier->buckets[i];
+        if (h->buckets[i] > 0) {
+            if (first == -1) {
+                first = i;
+            }
+            last = i;
+        }
+    }
+    
+    if (first == -1) {
+        h->min = h->max = 0;
+        return;
+    }
+    if (bucket_lowest(first) > h->min) {
+        h->min = bucket_lowest(first);
+    }
+    if (bucket_highest(last) < h->max) {
+        h->max = (int)bucket_highest(last);
+    }
+}
+
+int hist_percentile(const Histogram* h, double q) {
+    if (h->count == 0) {
+        return 0;
+    }
+    
+    long long rank = (long long)(q * h->count);
+    if (rank < q * h->count) {
+        rank++; // Round up
+    }
+    if (rank < 1) {
+        rank = 1;
+    }
+    
+    long long seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            long long value = bucket_highest(i);
+            if (value > h->max) {
+                value = h->max;
+            }
+            return value < h->min ? h->min : (int)value;
+        }
+    }
+    return h->max;
+}
+
+double hist_mean(const Histogram* h) {
+    return h->count > 0 ? (double)h->sum / h->count : 0.0;
+}
+
+int hist_latency_class(int priority) {
+    if (priority < 0) {
+        return 0;
+    }
+    return priority < LATENCY_TOP_PRIORITY ? priority : LATENCY_TOP_PRIORITY;
+}
+
+void hist_record_job(LatencyStats* stats, const Job* job) {
+    if (!stats || job->start_time < 0) {
+        return;
+    }
+    
+    int wait = job->start_time - job->arrival_time;
+    int turnaround = job->finish_time - job->arrival_time;
+    int latency_class = hist_latency_class(job->priority);
+    hist_record(&stats->wait[latency_class], wait);
+    hist_record(&stats->turnaround[latency_class], turnaround);
+    hist_record(&stats->wait[LATENCY_ALL], wait);
+    hist_record(&stats->turnaround[LATENCY_ALL], turnaround);
+}
+
+static void print_class(const LatencyStats* stats, int latency_class) {
+    const Histogram* wait = &stats->wait[latency_class];
+    const Histogram* turnaround = &stats->turnaround[latency_class];
+    
+    if (latency_class == LATENCY_ALL) {
+        printf("  All priorities: ");
+    } else if (latency_class == LATENCY_TOP_PRIORITY) {
+        printf("  Priority %d+: ", LATENCY_TOP_PRIORITY);
+    } else {
+        printf("  Priority %d: ", latency_class);
+    }
+    printf("%lld jobs\n", wait->count);
+    printf("    Wait:       p50=%d p99=%d p99.9=%d max=%d (mean %.2f)\n",
+           hist_percentile(wait, 0.5), hist_percentile(wait, 0.99),
+           hist_percentile(wait, 0.999), wait->max, hist_mean(wait));
+    printf("    Turnaround: p50=%d p99=%d p99.9=%d max=%d (mean %.2f)\n",
+           hist_percentile(turnaround, 0.5), hist_percentile(turnaround, 0.99),
+           hist_percentile(turnaround, 0.999), turnaround->max, hist_mean(turnaround));
+}
+
+void hist_print_latency(const LatencyStats* stats, int priority) {
+    printf("\n=== Job Latency (ticks from arrival) ===\n\n");
+    
+    if (priority >= 0) {
+        int latency_class = hist_latency_class(priority);
+        if (stats->wait[latency_class].count == 0) {
+            printf("  No completed jobs at priority %d\n\n", priority);
+            return;
+        }
+        print_class(stats, latency_class);
+        printf("\n");
+        return;
+    }
+    
+    if (stats->wait[LATENCY_ALL].count == 0) {
+        printf("  No completed jobs\n\n");
+        return;
+    }
+    for (int i = LATENCY_TOP_PRIORITY; i >= 0; i--) {
+        if (stats->wait[i].count > 0) {
+            print_class(stats, i);
+        }
+    }
+    print_class(stats, LATENCY_ALL);
+    printf("\n");
+}
@@ -0,0 +1,37 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "structs.h"
+
+// Clear a histogram
+void hist_reset(Histogram* h);
+
+// Record one value (negative values are recorded as 0), O(1)
+void hist_record(Histogram* h, int value);
+
+// Remove the values of an earlier copy of h, leaving what was recorded
+// since. The exact minimum and maximum of what remains are not known; they
+// are narrowed to the bounds of the lowest and highest non-empty buckets
+void hist_subtract(Histogram* h, const Histogram* earlier);
+
+// Value at quantile q (0 < q <= 1): the highest value in the bucket holding
+// the ceil(q * count)-th smallest recorded value, clamped to the exact
+// minimum and maximum. O(HISTOGRAM_BUCKETS)
+// Returns 0 for an empty histogram
+int hist_percentile(const Histogram* h, double q);
+
+// Mean of the recorded values (exact), 0 for an empty histogram
+double hist_mean(const Histogram* h);
+
+// Latency class of a priority level (see LatencyStats)
+int hist_latency_class(int priority);
+
+// Record a completed job's wait and turnaround in its priority class and
+// in LATENCY_ALL; jobs that never started are ignored
+void hist_record_job(LatencyStats* stats, const Job* job);
+
+// Print p50/p99/p99.9 wait and turnaround for one priority level, or for
+// every priority level with completed jobs when priority is negative
+void hist_print_latency(const LatencyStats* stats, int priority);
+
+#endif // HISTOGRAM_H
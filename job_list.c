@@ -1,77 +1,188 @@
 #include "job_list.h"
+#include "job_pool.h"
+#include "histogram.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
-JobList* jl_create(void) {
+// Number of recent jobs listed by jl_print
+#define JL_PRINT_RECENT 10
+
+JobList* jl_create(JobPool* pool) {
     JobList* jl = (JobList*)malloc(sizeof(JobList));
     if (!jl) {
         return NULL;
     }
     
-    jl->head = NULL;
+    jl->chunks = NULL;
+    jl->first_chunk = 0;
+    jl->chunk_count = 0;
+    jl->chunk_capacity = 0;
+    jl->spare = NULL;
+    jl->head = 0;
     jl->size = 0;
+    jl->retention = 0;
+    jl->pool = pool;
+    memset(&jl->stats, 0, sizeof(jl->stats));
+    jl->latency = (LatencyStats*)calloc(1, sizeof(LatencyStats));
+    if (!jl->latency) {
+        free(jl);
+        return NULL;
+    }
     return jl;
 }
 
+// Append an empty chunk at the end of the chunk array
+static int jl_push_chunk(JobList* jl) {
+    if (jl->first_chunk + jl->chunk_count >= jl->chunk_capacity) {
+        if (jl->first_chunk > 0) {
+            // Reclaim the slots of evicted chunks at the front
+            memmove(jl->chunks, jl->chunks + jl->first_chunk, jl->chunk_count * sizeof(JobChunk*));
+            jl->first_chunk = 0;
+        }
+        if (jl->chunk_count >= jl->chunk_capacity) {
+            int new_capacity = jl->chunk_capacity * 2;
+            if (new_capacity == 0) new_capacity = 8;
+            JobChunk** new_chunks = (JobChunk**)realloc(jl->chunks, new_capacity * sizeof(JobChunk*));
+            if (!new_chunks) {
+                return 0; // Failed to resize
+            }
+            jl->chunks = new_chunks;
+            jl->chunk_capacity = new_capacity;
+        }
+    }
+    
+    JobChunk* chunk = jl->spare;
+    jl->spare = NULL;
+    if (!chunk) {
+        chunk = (JobChunk*)malloc(sizeof(JobChunk));
+        if (!chunk) {
+            return 0; // Failed to allocate
+        }
+    }
+    
+    jl->chunks[jl->first_chunk + jl->chunk_count] = chunk;
+    jl->chunk_count++;
+    return 1;
+}
+
+// Drop the oldest retained job, releasing it to the pool
+static void jl_evict_oldest(JobList* jl) {
+    Job* job = jl->chunks[jl->first_chunk]->jobs[jl->head];
+    if (jl->pool) {
+        jp_release(jl->pool, job);
+    }
+    
+    jl->head++;
+    jl->size--;
+    
+    // Retire the first chunk once all of its jobs are gone
+    if (jl->head == JOB_LIST_CHUNK_SIZE || jl->size == 0) {
+        JobChunk* chunk = jl->chunks[jl->first_chunk];
+        if (jl->spare) {
+            free(chunk);
+        } else {
+            jl->spare = chunk;
+        }
+        jl->first_chunk++;
+        jl->chunk_count--;
+        jl->head = 0;
+    }
+}
+
 int jl_add(JobList* jl, Job* job) {
     if (!jl || !job) {
         return 0; // Error
     }
     
-    JobNode* new_node = (JobNode*)malloc(sizeof(JobNode));
-    if (!new_node) {
-        return 0; // Failed to allocate
+    // Start a new chunk when the tail chunk is full
+    int position = jl->head + jl->size;
+    if (position >= jl->chunk_count * JOB_LIST_CHUNK_SIZE) {
+        if (!jl_push_chunk(jl)) {
+            return 0; // Failed to allocate
+        }
     }
     
-    new_node->job = job;
-    new_node->next = NULL;
+    JobChunk* tail = jl->chunks[jl->first_chunk + position / JOB_LIST_CHUNK_SIZE];
+    tail->jobs[position % JOB_LIST_CHUNK_SIZE] = job;
+    jl->size++;
     
-    // Add to the end of the list
-    if (jl->head == NULL) {
-        jl->head = new_node;
-    } else {
-        JobNode* current = jl->head;
-        while (current->next) {
-            current = current->next;
-        }
-        current->next = new_node;
+    // Update the aggregate counters
+    jl->stats.completed++;
+    if (job->start_time >= 0) {
+        jl->stats.total_wait += job->start_time - job->arrival_time;
+        jl->stats.total_turnaround += job->finish_time - job->arrival_time;
     }
+    jl->stats.cpu_ticks += (long long)job->required_cpu * job->duration;
+    jl->stats.ram_ticks += (long long)job->required_ram * job->duration;
+    hist_record_job(jl->latency, job);
     
-    jl->size++;
+    if (jl->retention > 0 && jl->size > jl->retention) {
+        jl_evict_oldest(jl);
+    }
     return 1; // Success
 }
 
+void jl_set_retention(JobList* jl, int limit) {
+    if (!jl) {
+        return;
+    }
+    
+    jl->retention = limit > 0 ? limit : 0;
+    while (jl->retention > 0 && jl->size > jl->retention) {
+        jl_evict_oldest(jl);
+    }
+}
+
 int jl_size(JobList* jl) {
     return jl ? jl->size : 0;
 }
 
+long long jl_total(JobList* jl) {
+    return jl ? jl->stats.completed : 0;
+}
+
+Job* jl_get(JobList* jl, int index) {
+    if (!jl || index < 0 || index >= jl->size) {
+        return NULL;
+    }
+    
+    int position = jl->head + index;
+    return jl->chunks[jl->first_chunk + position / JOB_LIST_CHUNK_SIZE]->jobs[position % JOB_LIST_CHUNK_SIZE];
+}
+
 void jl_print(JobList* jl) {
-    if (!jl || !jl->head) {
+    if (!jl || jl->stats.completed == 0) {
         printf("  (none)\n");
         return;
     }
     
-    JobNode* current = jl->head;
-    while (current) {
+    printf("  Total: %lld jobs (%d retained)\n", jl->stats.completed, jl->size);
+    printf("  Average wait: %.2f ticks, average turnaround: %.2f ticks\n",
+           (double)jl->stats.total_wait / jl->stats.completed,
+           (double)jl->stats.total_turnaround / jl->stats.completed);
+    
+    // List only the most recent jobs
+    int first = jl->size > JL_PRINT_RECENT ? jl->size - JL_PRINT_RECENT : 0;
+    for (int i = first; i < jl->size; i++) {
+        Job* job = jl_get(jl, i);
         printf("  Job %d: Priority=%d, CPU=%d, RAM=%d, Duration=%d\n",
-               current->job->job_id,
-               current->job->priority,
-               current->job->required_cpu,
-               current->job->required_ram,
-               current->job->duration);
-        current = current->next;
+               job->job_id,
+               job->priority,
+               job->required_cpu,
+               job->required_ram,
+               job->duration);
     }
 }
 
 void jl_free(JobList* jl) {
     if (jl) {
-        JobNode* current = jl->head;
-        while (current) {
-            JobNode* next = current->next;
-            free(current);
-            current = next;
+        for (int i = 0; i < jl->chunk_count; i++) {
+            free(jl->chunks[jl->first_chunk + i]);
         }
+        free(jl->chunks);
+        free(jl->spare);
+        free(jl->latency);
         free(jl);
     }
 }
-
@@ -3,20 +3,29 @@
 
 #include "structs.h"
 
-// Create a new job list
-JobList* jl_create(void);
+// Create a new job list; evicted jobs are released to pool (may be NULL)
+JobList* jl_create(JobPool* pool);
 
-// Add a job to the list (adds to the end)
+// Add a job to the list (adds to the end, O(1))
+// Evicts the oldest job if the retention window is exceeded
 int jl_add(JobList* jl, Job* job);
 
-// Get the size of the list
+// Keep at most limit jobs in memory (0 = unlimited), evicting immediately
+void jl_set_retention(JobList* jl, int limit);
+
+// Get the number of retained jobs
 int jl_size(JobList* jl);
 
+// Get the number of jobs ever added, including evicted ones
+long long jl_total(JobList* jl);
+
+// Get the i-th retained job, oldest first (O(1))
+Job* jl_get(JobList* jl, int index);
+
 // Free the job list (does not free jobs themselves)
 void jl_free(JobList* jl);
 
-// Traverse the list and print jobs (for status command)
+// Print the aggregate counters and the most recent jobs (for status command)
 void jl_print(JobList* jl);
 
 #endif // JOB_LIST_H
-
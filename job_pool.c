@@ -0,0 +1,113 @@
+#include "job_pool.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+JobPool* jp_create(void) {
+    JobPool* pool = (JobPool*)malloc(sizeof(JobPool));
+    if (!pool) {
+        return NULL;
+    }
+    
+    pool->slabs = NULL;
+    pool->slab_count = 0;
+    pool->slab_capacity = 0;
+    pool->next_unused = 0;
+    pool->free_head = -1;
+    pool->live = 0;
+    return pool;
+}
+
+// Add one slab of JOB_POOL_SLAB_SIZE jobs
+static int jp_grow(JobPool* pool) {
+    if (pool->slab_count >= pool->slab_capacity) {
+        int new_capacity = pool->slab_capacity * 2;
+        if (new_capacity == 0) new_capacity = 8;
+        Job** new_slabs = (Job**)realloc(pool->slabs, new_capacity * sizeof(Job*));
+        if (!new_slabs) {
+            return 0; // Failed to resize
+        }
+        pool->slabs = new_slabs;
+        pool->slab_capacity = new_capacity;
+    }
+    
+    Job* slab = (Job*)malloc(JOB_POOL_SLAB_SIZE * sizeof(Job));
+    if (!slab) {
+        return 0; // Failed to allocate
+    }
+    
+    pool->slabs[pool->slab_count++] = slab;
+    return 1;
+}
+
+Job* jp_get(JobPool* pool, int handle) {
+    if (!pool || handle < 0 || handle >= pool->next_unused) {
+        return NULL;
+    }
+    return &pool->slabs[handle / JOB_POOL_SLAB_SIZE][handle % JOB_POOL_SLAB_SIZE];
+}
+
+Job* jp_alloc(JobPool* pool) {
+    if (!pool) {
+        return NULL;
+    }
+    
+    // Reuse a released job first
+    if (pool->free_head != -1) {
+        int handle = pool->free_head;
+        Job* job = jp_get(pool, handle);
+        pool->free_head = job->handle; // Next released job
+        job->handle = handle;
+        pool->live++;
+        return job;
+    }
+    
+    // Otherwise bump-allocate from the last slab
+    if (pool->next_unused >= pool->slab_count * JOB_POOL_SLAB_SIZE) {
+        if (!jp_grow(pool)) {
+            return NULL; // Failed to allocate
+        }
+    }
+    
+    int handle = pool->next_unused++;
+    Job* job = jp_get(pool, handle);
+    job->handle = handle;
+    pool->live++;
+    return job;
+}
+
+void jp_release(JobPool* pool, Job* job) {
+    if (!pool || !job) {
+        return;
+    }
+    
+    int handle = job->handle;
+    job->handle = pool->free_head;
+    pool->free_head = handle;
+    pool->live--;
+}
+
+int jp_live(JobPool* pool) {
+    return pool ? pool->live : 0;
+}
+
+void jp_clear(JobPool* pool) {
+    if (!pool) {
+        return;
+    }
+    
+    pool->next_unused = 0;
+    pool->free_head = -1;
+    pool->live = 0;
+}
+
+void jp_free(JobPool* pool) {
+    if (!pool) {
+        return;
+    }
+    
+    for (int i = 0; i < pool->slab_count; i++) {
+        free(pool->slabs[i]);
+    }
+    free(pool->slabs);
+    free(pool);
+}
@@ -0,0 +1,28 @@
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+#include "structs.h"
+
+// Create an empty job pool
+JobPool* jp_create(void);
+
+// Allocate a job from the pool (fields other than handle are uninitialized)
+// Returns NULL if a new slab could not be allocated
+Job* jp_alloc(JobPool* pool);
+
+// Return a job to the pool so its storage can be reused
+void jp_release(JobPool* pool, Job* job);
+
+// Get a job by its handle, or NULL if the handle was never allocated
+Job* jp_get(JobPool* pool, int handle);
+
+// Get the number of jobs currently allocated
+int jp_live(JobPool* pool);
+
+// Release every job at once, keeping the slabs for reuse
+void jp_clear(JobPool* pool);
+
+// Free the pool and every job allocated from it (one free per slab)
+void jp_free(JobPool* pool);
+
+#endif // JOB_POOL_H
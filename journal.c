@@ -0,0 +1,199 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // fsync, fileno
+#endif
+
+#include "journal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#define fsync_file(file) _commit(_fileno(file))
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#define fsync_file(file) fsync(fileno(file))
+#endif
+
+#define JOURNAL_HEADER "# Cloud Job Scheduler Journal\n"
+#define MAX_RECORD_LENGTH 1024
+
+Journal* journal_open(const char* path, int group_size) {
+    if (!path || strlen(path) >= sizeof(((Journal*)0)->path)) {
+        return NULL;
+    }
+    
+    Journal* journal = (Journal*)malloc(sizeof(Journal));
+    if (!journal) {
+        return NULL;
+    }
+    
+    journal->file = fopen(path, "a");
+    if (!journal->file) {
+        free(journal);
+        return NULL; // Failed to open file
+    }
+    
+    strcpy(journal->path, path);
+    journal->group_size = group_size > 0 ? group_size : 1;
+    journal->unsynced = 0;
+    journal->records = 0;
+    
+    // A new journal starts with a header line
+    if (ftell(journal->file) == 0) {
+        fputs(JOURNAL_HEADER, journal->file);
+    }
+    return journal;
+}
+
+int journal_sync(Journal* journal) {
+    if (!journal || !journal->file) {
+        return 0;
+    }
+    
+    if (fflush(journal->file) != 0 || fsync_file(journal->file) != 0) {
+        return 0; // Failed to reach stable storage
+    }
+    journal->unsynced = 0;
+    return 1;
+}
+
+int journal_append(Journal* journal, const char* record) {
+    if (!journal || !journal->file || !record) {
+        return 0;
+    }
+    
+    if (fputs(record, journal->file) == EOF || fputc('\n', journal->file) == EOF) {
+        return 0; // Failed to write
+    }
+    journal->records++;
+    
+    // Group commit: one fsync covers a whole batch of records
+    if (++journal->unsynced >= journal->group_size) {
+        return journal_sync(journal);
+    }
+    return 1;
+}
+
+int sync_file_close(FILE* file) {
+    int ok = fflush(file) == 0 && fsync_file(file) == 0;
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    return ok;
+}
+
+int replace_file(const char* temp_path, const char* path) {
+#ifdef _WIN32
+    // Write-through makes the rename durable before it returns
+    return MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (rename(temp_path, path) != 0) {
+        return 0;
+    }
+    
+    // The rename only survives a crash once the directory entry is synced
+    char dir[512];
+    const char* slash = strrchr(path, '/');
+    if (!slash) {
+        strcpy(dir, ".");
+    } else if (slash == path) {
+        strcpy(dir, "/");
+    } else if ((size_t)(slash - path) < sizeof(dir)) {
+        memcpy(dir, path, (size_t)(slash - path));
+        dir[slash - path] = '\0';
+    } else {
+        return 0; // Path too long
+    }
+    
+    int fd = open(dir, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    int ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+#endif
+}
+
+int journal_truncate(Journal* journal, const char* snapshot) {
+    if (!journal || !snapshot) {
+        return 0;
+    }
+    
+    // Build the restarted journal beside the old one and swap it in, so a
+    // crash leaves either the old journal or the new one, never neither
+    char temp_path[sizeof(journal->path) + 4];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", journal->path);
+    FILE* temp = fopen(temp_path, "w");
+    if (!temp) {
+        return 0; // Failed to create file
+    }
+    int written = fputs(JOURNAL_HEADER, temp) != EOF && fprintf(temp, "load %s\n", snapshot) > 0;
+    if (!sync_file_close(temp) || !written) {
+        remove(temp_path);
+        return 0; // Failed to reach stable storage; the old journal stays
+    }
+    
+    // Pending records belong to the state the snapshot already holds
+    if (journal->file) {
+        fclose(journal->file);
+        journal->file = NULL;
+    }
+    if (!replace_file(temp_path, journal->path)) {
+        remove(temp_path);
+        journal->file = fopen(journal->path, "a");
+        return 0;
+    }
+    
+    journal->file = fopen(journal->path, "a");
+    if (!journal->file) {
+        return 0; // Failed to reopen file
+    }
+    journal->unsynced = 0;
+    journal->records = 0;
+    return 1;
+}
+
+long long journal_replay(const char* path, journal_replay_callback callback, void* user_data) {
+    if (!path || !callback) {
+        return -1;
+    }
+    
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return -1; // Failed to open file
+    }
+    
+    char line[MAX_RECORD_LENGTH];
+    long long replayed = 0;
+    while (fgets(line, sizeof(line), file)) {
+        size_t length = strlen(line);
+        if (length == 0 || line[length - 1] != '\n') {
+            break; // Torn record from an interrupted write
+        }
+        if (line[0] == '#' || line[0] == '\n') {
+            continue; // Comment or empty line
+        }
+        
+        line[length - 1] = '\0';
+        callback(line, user_data);
+        replayed++;
+    }
+    
+    fclose(file);
+    return replayed;
+}
+
+void journal_close(Journal* journal) {
+    if (!journal) {
+        return;
+    }
+    
+    if (journal->file) {
+        journal_sync(journal);
+        fclose(journal->file);
+    }
+    free(journal);
+}
@@ -0,0 +1,57 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdio.h>
+
+// Write-ahead journal of state-changing commands
+// Each record is one command line. After a snapshot the journal is truncated
+// and restarted with a "load <snapshot>" record, so recovery is simply
+// replaying every record in order.
+typedef struct {
+    FILE* file;
+    char path[256];
+    int group_size;     // Records per fsync (group commit)
+    int unsynced;       // Records written since the last fsync
+    long long records;  // Records written since the journal was last truncated
+} Journal;
+
+// Callback invoked for every complete record during replay
+typedef void (*journal_replay_callback)(const char* record, void* user_data);
+
+// Open (or create) a journal for appending
+// Records are fsync'ed in groups of group_size (1 = every record)
+// Returns NULL on failure
+Journal* journal_open(const char* path, int group_size);
+
+// Append a record; syncs once group_size records are pending
+// Returns 1 on success, 0 on failure
+int journal_append(Journal* journal, const char* record);
+
+// Flush and fsync all pending records
+// Returns 1 on success, 0 on failure
+int journal_sync(Journal* journal);
+
+// Discard all records and restart the journal from a snapshot file
+// The new journal is written to "<path>.tmp", fsync'ed and renamed over the
+// old one, so a crash at any point leaves a complete journal behind
+// Returns 1 on success, 0 on failure
+int journal_truncate(Journal* journal, const char* snapshot);
+
+// Flush, fsync and close a file
+// Returns 1 if everything reached stable storage, 0 otherwise
+int sync_file_close(FILE* file);
+
+// Atomically replace path with temp_path (already fsync'ed) and sync the
+// directory, so the new file survives a crash; shared with snapshot saving
+// Returns 1 on success, 0 on failure (temp_path is left in place)
+int replace_file(const char* temp_path, const char* path);
+
+// Replay every complete record of the journal at path (a torn final record
+// left by a crash is ignored)
+// Returns the number of records replayed, or -1 if the file cannot be read
+long long journal_replay(const char* path, journal_replay_callback callback, void* user_data);
+
+// Sync and close the journal
+void journal_close(Journal* journal);
+
+#endif // JOURNAL_H
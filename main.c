@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "structs.h"
 #include "node_list.h"
 #include "priority_queue.h"
@@ -8,77 +9,175 @@
 #include "job_list.h"
 #include "scheduler.h"
 #include "persistence.h"
+#include "job_pool.h"
+#include "journal.h"
+#include "metrics.h"
+#include "histogram.h"
+#include "trace.h"
+#include "replay.h"
 
 #define MAX_LINE_LENGTH 1024
 #define MAX_FILENAME_LENGTH 256
+#define DEFAULT_TRACE_EVENTS 65536
+#define DEFAULT_REPLAY_HISTORY 10000 // Completed jobs a replay keeps unless told otherwise
 
 // Global state
 static int current_time = 0;
 static int next_job_id = 1;
+static PlacementPolicy placement_policy = PLACEMENT_FIRST_FIT;
+static QueueKind queue_kind = PQ_KIND_HEAP;
+static int aging_ticks = 0;       // Ticks of waiting worth one priority level (0 = off)
+static JobPool* job_pool = NULL;
+static int history_retention = 0; // Completed jobs kept in memory (0 = unlimited)
+static Journal* journal = NULL;    // Write-ahead journal (NULL = disabled)
+static Scheduler* scheduler = NULL; // Settings and state kept across ticks
+
+#define DEFAULT_JOURNAL_GROUP_SIZE 64
+#define DEFAULT_METRICS_INTERVAL 10   // Ticks between Prometheus dumps
+
+// Record a successfully executed state-changing command in the journal
+static void journal_command(const char* line) {
+    if (journal && !journal_append(journal, line)) {
+        printf("Warning: Failed to write to journal %s\n", journal->path);
+    }
+}
+
+// Journal a step of a trace replay (replay_record_callback)
+static void journal_replay_step(const char* command, void* user_data) {
+    (void)user_data;
+    journal_command(command);
+}
+
+// Restart the journal from a snapshot that now holds the full state
+static void journal_checkpoint(const char* snapshot) {
+    if (journal && !journal_truncate(journal, snapshot)) {
+        printf("Warning: Failed to truncate journal %s\n", journal->path);
+    }
+}
 
 // Function to free all allocated memory
-void cleanup(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs) {
-    // Use a simple approach: collect all job pointers first, then free them once
-    // This avoids double-freeing when jobs move between structures
+void cleanup(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, JobPool* pool) {
+    // Free nodes
+    for (int i = 0; i < nodes->size; i++) {
+        free(nodes->nodes[i]);
+    }
     
-    // First, collect all unique job pointers
-    #define MAX_JOBS 10000
-    Job* jobs_to_free[MAX_JOBS];
-    int job_count = 0;
+    // Free data structures (these free their own storage, but not jobs)
+    nl_free(nodes);
+    pq_free(pq);
+    ht_free(running_jobs);
+    jl_free(completed_jobs);
     
-    // Collect jobs from priority queue
-    while (!pq_is_empty(pq) && job_count < MAX_JOBS) {
-        Job* job = pq_extract_min(pq);
-        if (job) {
-            jobs_to_free[job_count++] = job;
-        }
+    // Every job lives in the pool, wherever it currently is
+    jp_free(pool);
+}
+
+// Submit every job in a batch file (one "<priority> <cpu> <ram> <duration>"
+// per line; blank lines and '#' comments are skipped). The whole file is
+// validated first, so either every job is queued or none is.
+// Returns the number of jobs submitted, or -1 on error
+static int submit_batch(const char* filename, NodeList* nodes, PriorityQueue* pq) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        printf("Error: Cannot open batch file %s\n", filename);
+        return -1;
     }
     
-    // Collect jobs from hash table (running jobs that haven't completed)
-    for (int i = 0; i < running_jobs->size && job_count < MAX_JOBS; i++) {
-        HashNode* current = running_jobs->table[i];
-        while (current && job_count < MAX_JOBS) {
-            if (current->job) {
-                jobs_to_free[job_count++] = current->job;
-            }
-            current = current->next;
-        }
+    if (nodes->size == 0) {
+        printf("Error: No nodes available. Add nodes first.\n");
+        fclose(file);
+        return -1;
     }
     
-    // Collect jobs from completed list
-    JobNode* current = completed_jobs->head;
-    while (current && job_count < MAX_JOBS) {
-        if (current->job) {
-            // Check if we already have this job (shouldn't happen, but be safe)
-            int found = 0;
-            for (int i = 0; i < job_count; i++) {
-                if (jobs_to_free[i] == current->job) {
-                    found = 1;
+    Job** jobs = NULL;
+    int count = 0, capacity = 0, line_number = 0, ok = 1;
+    char line[MAX_LINE_LENGTH];
+    
+    while (ok && fgets(line, sizeof(line), file)) {
+        int priority, cpu, ram, duration;
+        char extra;
+        line_number++;
+        
+        char* p = line + strspn(line, " \t");
+        if (*p == '\n' || *p == '\r' || *p == '\0' || *p == '#') {
+            continue;
+        }
+        
+        if (sscanf(p, "%d %d %d %d %c", &priority, &cpu, &ram, &duration, &extra) != 4) {
+            printf("Error: %s:%d: expected <priority> <cpu> <ram> <duration>\n", filename, line_number);
+            ok = 0;
+        } else if (priority < 0 || cpu <= 0 || ram <= 0 || duration <= 0) {
+            printf("Error: %s:%d: priority must be non-negative, and CPU, RAM, and duration must be positive\n",
+                   filename, line_number);
+            ok = 0;
+        } else if (cpu > nodes->max_total_cpu || ram > nodes->max_total_ram) {
+            printf("Error: %s:%d: job requires more resources (CPU=%d, RAM=%d) than any node can provide (max CPU=%d, max RAM=%d)\n",
+                   filename, line_number, cpu, ram, nodes->max_total_cpu, nodes->max_total_ram);
+            ok = 0;
+        } else {
+            if (count == capacity) {
+                int new_capacity = capacity ? capacity * 2 : 64;
+                Job** new_jobs = (Job**)realloc(jobs, new_capacity * sizeof(Job*));
+                if (!new_jobs) {
+                    printf("Error: Failed to allocate memory for batch\n");
+                    ok = 0;
                     break;
                 }
+                jobs = new_jobs;
+                capacity = new_capacity;
             }
-            if (!found) {
-                jobs_to_free[job_count++] = current->job;
+            
+            Job* job = jp_alloc(job_pool);
+            if (!job) {
+                printf("Error: Failed to allocate memory for job\n");
+                ok = 0;
+                break;
             }
+            
+            job->priority = priority;
+            job->required_cpu = cpu;
+            job->required_ram = ram;
+            job->duration = duration;
+            job->status = 0; // Pending
+            job->arrival_time = current_time;
+            job->start_time = -1;
+            job->finish_time = -1;
+            jobs[count++] = job;
         }
-        current = current->next;
     }
+    fclose(file);
     
-    // Free all collected jobs (each job freed exactly once)
-    for (int i = 0; i < job_count; i++) {
-        free(jobs_to_free[i]);
+    if (ok) {
+        for (int i = 0; i < count; i++) {
+            jobs[i]->job_id = next_job_id + i;
+        }
+        ok = pq_insert_batch(pq, jobs, count);
+        if (!ok) {
+            printf("Error: Failed to add jobs to priority queue\n");
+        }
     }
     
-    // Free nodes
-    for (int i = 0; i < nodes->size; i++) {
-        free(nodes->nodes[i]);
+    if (!ok) {
+        for (int i = 0; i < count; i++) {
+            jp_release(job_pool, jobs[i]);
+        }
+        free(jobs);
+        return -1;
     }
     
-    // Free data structures (these will free HashNodes and JobNodes, but not jobs)
-    nl_free(nodes);
-    pq_free(pq);
-    ht_free(running_jobs);  // Frees HashNode structures only
-    jl_free(completed_jobs);  // Frees JobNode structures only
+    // Journal each job as an add-job so recovery does not depend on the
+    // batch file still existing
+    next_job_id += count;
+    for (int i = 0; i < count; i++) {
+        TRACE_JOB(scheduler, TRACE_SUBMIT, jobs[i], -1, current_time);
+        char record[128];
+        snprintf(record, sizeof(record), "add-job %d %d %d %d", jobs[i]->priority,
+                 jobs[i]->required_cpu, jobs[i]->required_ram, jobs[i]->duration);
+        journal_command(record);
+    }
+    
+    free(jobs);
+    return count;
 }
 
 // Parse and execute commands
@@ -130,6 +229,7 @@ int execute_command(char* line, NodeList** nodes_ptr, PriorityQueue** pq_ptr, Ha
         }
         
         printf("Added node %d: CPU=%d, RAM=%d\n", node->node_id, node->total_cpu, node->total_ram);
+        journal_command(line);
         
     } else if (strcmp(command, "add-job") == 0) {
         if (sscanf(line, "add-job %d %d %d %d", &arg2, &arg3, &arg4, &arg5) != 4) {
@@ -143,25 +243,18 @@ int execute_command(char* line, NodeList** nodes_ptr, PriorityQueue** pq_ptr, Ha
         }
         
         // Check if any node can handle this job
-        int max_cpu = 0, max_ram = 0;
-        for (int i = 0; i < nodes->size; i++) {
-            ResourceNode* node = nl_get(nodes, i);
-            if (node->total_cpu > max_cpu) max_cpu = node->total_cpu;
-            if (node->total_ram > max_ram) max_ram = node->total_ram;
-        }
-        
         if (nodes->size == 0) {
             printf("Error: No nodes available. Add nodes first.\n");
             return 1;
         }
         
-        if (arg3 > max_cpu || arg4 > max_ram) {
+        if (arg3 > nodes->max_total_cpu || arg4 > nodes->max_total_ram) {
             printf("Error: Job requires more resources (CPU=%d, RAM=%d) than any node can provide (max CPU=%d, max RAM=%d)\n",
-                   arg3, arg4, max_cpu, max_ram);
+                   arg3, arg4, nodes->max_total_cpu, nodes->max_total_ram);
             return 1;
         }
         
-        Job* job = (Job*)malloc(sizeof(Job));
+        Job* job = jp_alloc(job_pool);
         if (!job) {
             printf("Error: Failed to allocate memory for job\n");
             return 1;
@@ -174,24 +267,331 @@ int execute_command(char* line, NodeList** nodes_ptr, PriorityQueue** pq_ptr, Ha
         job->duration = arg5;
         job->status = 0; // Pending
         job->arrival_time = current_time;
+        job->start_time = -1;
+        job->finish_time = -1;
         
         if (!pq_insert(pq, job)) {
             printf("Error: Failed to add job to priority queue\n");
-            free(job);
+            jp_release(job_pool, job);
             return 1;
         }
+        TRACE_JOB(scheduler, TRACE_SUBMIT, job, -1, current_time);
         
         printf("Added job %d: Priority=%d, CPU=%d, RAM=%d, Duration=%d\n",
                job->job_id, job->priority, job->required_cpu,
                job->required_ram, job->duration);
+        journal_command(line);
+        
+    } else if (strcmp(command, "submit-batch") == 0) {
+        if (sscanf(line, "submit-batch %255s", arg1) != 1) {
+            printf("Error: Usage: submit-batch <filename>\n");
+            return 1;
+        }
+        
+        int first_id = next_job_id;
+        int submitted = submit_batch(arg1, nodes, pq);
+        if (submitted > 0) {
+            printf("Submitted %d jobs from %s (IDs %d-%d)\n", submitted, arg1, first_id, next_job_id - 1);
+        } else if (submitted == 0) {
+            printf("No jobs found in %s\n", arg1);
+        }
+        
+    } else if (strcmp(command, "replay") == 0) {
+        int fields = sscanf(line, "replay %255s %d", arg1, &arg2);
+        if (fields < 1 || (fields == 2 && arg2 < 0)) {
+            printf("Error: Usage: replay <trace.swf|trace.csv> [history]\n");
+            return 1;
+        }
+        if (nodes->size == 0) {
+            printf("Error: No nodes available. Add nodes first.\n");
+            return 1;
+        }
+        
+        // A trace can hold millions of jobs, so a replay always bounds the
+        // history: an explicit size (0 = keep everything) or, when none is
+        // set, a default. Either stays in effect like set-history
+        if (fields == 1 && history_retention == 0) {
+            arg2 = DEFAULT_REPLAY_HISTORY;
+            fields = 2;
+            printf("Keeping the last %d completed jobs in memory (replay <file> 0 keeps them all)\n", arg2);
+        }
+        if (fields == 2) {
+            char record[64];
+            history_retention = arg2;
+            jl_set_retention(completed_jobs, history_retention);
+            snprintf(record, sizeof(record), "set-history %d", history_retention);
+            journal_command(record);
+        }
+        
+        // Journal the submissions and time advances themselves, as they are
+        // applied, so recovery neither needs the trace file nor loses the
+        // progress of a replay that fails part way
+        ReplayReport report;
+        if (!replay_trace(arg1, scheduler, nodes, pq, running_jobs, completed_jobs, job_pool,
+                          &current_time, &next_job_id, journal ? journal_replay_step : NULL, NULL,
+                          &report)) {
+            printf("Error: Failed to replay %s\n", arg1);
+            return 1;
+        }
+        replay_print(arg1, &report);
+        
+    } else if (strcmp(command, "cancel") == 0) {
+        if (sscanf(line, "cancel %d", &arg2) != 1) {
+            printf("Error: Usage: cancel <job_id>\n");
+            return 1;
+        }
+        
+        Job* job = pq_find(pq, arg2);
+        if (!job) {
+            if (ht_find(running_jobs, arg2)) {
+                printf("Error: Job %d is already running; only pending jobs can be cancelled\n", arg2);
+            } else {
+                printf("Error: No pending job with ID %d\n", arg2);
+            }
+            return 1;
+        }
+        
+        pq_remove(pq, job);
+        jp_release(job_pool, job);
+        printf("Cancelled job %d\n", arg2);
+        journal_command(line);
+        
+    } else if (strcmp(command, "set-priority") == 0) {
+        if (sscanf(line, "set-priority %d %d", &arg2, &arg3) != 2) {
+            printf("Error: Usage: set-priority <job_id> <priority>\n");
+            return 1;
+        }
+        
+        if (arg3 < 0) {
+            printf("Error: Priority must be non-negative\n");
+            return 1;
+        }
+        
+        Job* job = pq_find(pq, arg2);
+        if (!job) {
+            if (ht_find(running_jobs, arg2)) {
+                printf("Error: Job %d is already running; only pending jobs can be reprioritized\n", arg2);
+            } else {
+                printf("Error: No pending job with ID %d\n", arg2);
+            }
+            return 1;
+        }
+        
+        int old_priority = job->priority;
+        if (!pq_update_priority(pq, job, arg3)) {
+            printf("Error: Failed to update job %d; it was dropped from the queue\n", arg2);
+            jp_release(job_pool, job);
+            return 1;
+        }
+        printf("Job %d priority changed from %d to %d\n", arg2, old_priority, arg3);
+        journal_command(line);
         
     } else if (strcmp(command, "run-tick") == 0) {
         current_time++;
-        run_scheduler_tick(nodes, pq, running_jobs, completed_jobs, current_time);
+        run_scheduler_tick(scheduler, nodes, pq, running_jobs, completed_jobs, current_time);
         printf("Simulation advanced to time %d\n", current_time);
+        journal_command(line);
+        
+    } else if (strcmp(command, "run-ticks") == 0 || strcmp(command, "run-until-idle") == 0) {
+        int end_time = INT_MAX;
+        int until_idle = strcmp(command, "run-until-idle") == 0;
+        if (!until_idle) {
+            if (sscanf(line, "run-ticks %d", &arg2) != 1 || arg2 <= 0) {
+                printf("Error: Usage: run-ticks <n> (n must be positive)\n");
+                return 1;
+            }
+            if (arg2 > INT_MAX - current_time) {
+                printf("Error: Simulation time would overflow\n");
+                return 1;
+            }
+            end_time = current_time + arg2;
+        }
+        
+        int start_time = current_time;
+        long long completed_before = jl_total(completed_jobs);
+        int passes = run_scheduler_until(scheduler, nodes, pq, running_jobs, completed_jobs, &current_time, end_time, until_idle);
+        printf("Simulation advanced to time %d (%d ticks, %d scheduler passes, %lld jobs completed)\n",
+               current_time, current_time - start_time, passes,
+               jl_total(completed_jobs) - completed_before);
+        journal_command(line);
+        
+    } else if (strcmp(command, "set-policy") == 0) {
+        PlacementPolicy policy;
+        if (sscanf(line, "set-policy %255s", arg1) != 1) {
+            printf("Error: Usage: set-policy <first-fit|best-fit|worst-fit|dot-product>\n");
+            return 1;
+        }
+        if (!nl_parse_policy(arg1, &policy)) {
+            printf("Error: Unknown placement policy '%s' (expected first-fit, best-fit, worst-fit or dot-product)\n", arg1);
+            return 1;
+        }
+        
+        placement_policy = policy;
+        nl_set_policy(nodes, placement_policy);
+        scheduler_invalidate(scheduler);
+        printf("Placement policy set to %s\n", nl_policy_name(placement_policy));
+        journal_command(line);
+        
+    } else if (strcmp(command, "set-queue") == 0) {
+        QueueKind kind;
+        if (sscanf(line, "set-queue %255s", arg1) != 1) {
+            printf("Error: Usage: set-queue <heap|bucket>\n");
+            return 1;
+        }
+        if (!pq_parse_kind(arg1, &kind)) {
+            printf("Error: Unknown queue kind '%s' (expected heap or bucket)\n", arg1);
+            return 1;
+        }
+        if (!pq_set_kind(pq, kind)) {
+            printf("Error: Failed to switch the pending queue to %s\n", pq_kind_name(kind));
+            return 1;
+        }
+        
+        queue_kind = kind;
+        printf("Pending queue set to %s\n", pq_kind_name(queue_kind));
+        journal_command(line);
+        
+    } else if (strcmp(command, "set-aging") == 0) {
+        if (sscanf(line, "set-aging %d", &arg2) != 1 || arg2 < 0) {
+            printf("Error: Usage: set-aging <ticks> (waiting ticks worth one priority level, 0 = off)\n");
+            return 1;
+        }
+        if (!pq_set_aging(pq, arg2)) {
+            printf("Error: Failed to reorder the pending queue\n");
+            return 1;
+        }
+        
+        aging_ticks = arg2;
+        if (aging_ticks == 0) {
+            printf("Aging disabled\n");
+        } else {
+            printf("Pending jobs gain one priority level every %d ticks\n", aging_ticks);
+        }
+        journal_command(line);
+        
+    } else if (strcmp(command, "set-backfill") == 0) {
+        if (sscanf(line, "set-backfill %d", &arg2) != 1 || arg2 < 0) {
+            printf("Error: Usage: set-backfill <depth> (pending jobs considered behind a blocked job, 0 = off)\n");
+            return 1;
+        }
+        
+        scheduler_set_backfill_depth(scheduler, arg2);
+        if (arg2 == 0) {
+            printf("Backfilling disabled\n");
+        } else {
+            printf("Backfilling up to %d jobs behind a blocked job\n", arg2);
+        }
+        journal_command(line);
+        
+    } else if (strcmp(command, "set-threads") == 0) {
+        if (sscanf(line, "set-threads %d", &arg2) != 1 || arg2 < 1) {
+            printf("Error: Usage: set-threads <n> (threads collecting completions, 1 = serial)\n");
+            return 1;
+        }
+        
+        if (!scheduler_set_threads(scheduler, arg2)) {
+            if (!wp_enabled()) {
+                printf("Error: Threads are disabled in this build (rebuild with SCHED_THREADS defined)\n");
+            } else {
+                printf("Error: Failed to start %d threads\n", arg2);
+            }
+            return 1;
+        }
+        // Not journaled: the thread count never changes the outcome
+        printf("Collecting completions on %d thread(s)\n", scheduler_threads(scheduler));
+        
+    } else if (strcmp(command, "set-history") == 0) {
+        if (sscanf(line, "set-history %d", &arg2) != 1 || arg2 < 0) {
+            printf("Error: Usage: set-history <n> (completed jobs kept in memory, 0 = unlimited)\n");
+            return 1;
+        }
+        
+        history_retention = arg2;
+        jl_set_retention(completed_jobs, history_retention);
+        if (history_retention == 0) {
+            printf("Completed job history is unlimited\n");
+        } else {
+            printf("Keeping the last %d completed jobs in memory\n", history_retention);
+        }
+        journal_command(line);
         
     } else if (strcmp(command, "status") == 0) {
-        print_status(nodes, pq, running_jobs, completed_jobs);
+        print_status(scheduler, nodes, pq, running_jobs, completed_jobs, current_time);
+        
+    } else if (strcmp(command, "stats") == 0) {
+        metrics_print(scheduler, nodes, pq, running_jobs, current_time);
+        
+    } else if (strcmp(command, "latency") == 0) {
+        int priority = -1;
+        if (sscanf(line, "latency %d", &priority) == 1 && priority < 0) {
+            printf("Error: Usage: latency [priority] (priority must be non-negative)\n");
+            return 1;
+        }
+        hist_print_latency(completed_jobs->latency, priority);
+        
+    } else if (strcmp(command, "set-metrics-file") == 0) {
+        if (sscanf(line, "set-metrics-file %255s", arg1) == 1 && strcmp(arg1, "off") == 0) {
+            metrics_set_dump(scheduler, NULL, 0);
+            printf("Metrics dump disabled\n");
+            return 1;
+        }
+        if (sscanf(line, "set-metrics-file %255s %d", arg1, &arg2) != 2 || arg2 <= 0) {
+            printf("Error: Usage: set-metrics-file <filename> <ticks> | set-metrics-file off\n");
+            return 1;
+        }
+        
+        if (!metrics_set_dump(scheduler, arg1, arg2)) {
+            printf("Error: Metrics are disabled in this build\n");
+            return 1;
+        }
+        if (!metrics_write_prometheus(arg1, scheduler, nodes, pq, running_jobs, current_time)) {
+            printf("Warning: Failed to write metrics to %s\n", arg1);
+        }
+        printf("Writing metrics to %s every %d ticks\n", arg1, arg2);
+        
+    } else if (strcmp(command, "trace") == 0) {
+        if (sscanf(line, "trace %255s", arg1) != 1) {
+            if (TRACE_ACTIVE(scheduler)) {
+                printf("Tracing: %d events buffered (capacity %d, %lld recorded)\n",
+                       trace_size(&scheduler->trace), scheduler->trace.capacity, scheduler->trace.recorded);
+            } else {
+                printf("Tracing is off\n");
+            }
+            return 1;
+        }
+        
+        if (strcmp(arg1, "on") == 0) {
+            int capacity = DEFAULT_TRACE_EVENTS;
+            if (sscanf(line, "trace on %d", &capacity) == 1 && capacity <= 0) {
+                printf("Error: Trace buffer size must be positive\n");
+                return 1;
+            }
+            if (!trace_start(&scheduler->trace, capacity)) {
+                printf("Error: Failed to allocate a trace buffer of %d events\n", capacity);
+                return 1;
+            }
+            printf("Tracing into a buffer of %d events\n", capacity);
+        } else if (strcmp(arg1, "off") == 0) {
+            trace_stop(&scheduler->trace);
+            printf("Tracing stopped\n");
+        } else if (strcmp(arg1, "dump") == 0) {
+            if (sscanf(line, "trace dump %255s", arg1) != 1) {
+                printf("Error: Usage: trace dump <filename>\n");
+                return 1;
+            }
+            if (!TRACE_ACTIVE(scheduler)) {
+                printf("Error: Tracing is off (start it with 'trace on')\n");
+                return 1;
+            }
+            if (!trace_write(&scheduler->trace, arg1, nodes)) {
+                printf("Error: Failed to write trace to %s\n", arg1);
+                return 1;
+            }
+            printf("Trace written to %s (%d events)\n", arg1, trace_size(&scheduler->trace));
+        } else {
+            printf("Error: Usage: trace on [events] | trace off | trace dump <filename>\n");
+            return 1;
+        }
         
     } else if (strcmp(command, "save") == 0) {
         if (sscanf(line, "save %255s", arg1) != 1) {
@@ -199,12 +599,25 @@ int execute_command(char* line, NodeList** nodes_ptr, PriorityQueue** pq_ptr, Ha
             return 1;
         }
         
-        if (save_state(arg1, nodes, pq, running_jobs, completed_jobs, current_time, next_job_id)) {
+        if (save_snapshot(arg1, nodes, pq, running_jobs, completed_jobs, current_time, next_job_id)) {
             printf("State saved to %s\n", arg1);
+            journal_checkpoint(arg1);
         } else {
             printf("Error: Failed to save state to %s\n", arg1);
         }
         
+    } else if (strcmp(command, "export") == 0) {
+        if (sscanf(line, "export %255s", arg1) != 1) {
+            printf("Error: Usage: export <filename>\n");
+            return 1;
+        }
+        
+        if (save_state(arg1, nodes, pq, running_jobs, completed_jobs, current_time, next_job_id)) {
+            printf("State exported to %s\n", arg1);
+        } else {
+            printf("Error: Failed to export state to %s\n", arg1);
+        }
+        
     } else if (strcmp(command, "load") == 0) {
         if (sscanf(line, "load %255s", arg1) != 1) {
             printf("Error: Usage: load <filename>\n");
@@ -212,7 +625,9 @@ int execute_command(char* line, NodeList** nodes_ptr, PriorityQueue** pq_ptr, Ha
         }
         
         // Clean up current state
-        cleanup(nodes, pq, running_jobs, completed_jobs);
+        cleanup(nodes, pq, running_jobs, completed_jobs, job_pool);
+        job_pool = jp_create();
+        scheduler_invalidate(scheduler);
         
         // Load new state
         NodeList* new_nodes;
@@ -220,20 +635,33 @@ int execute_command(char* line, NodeList** nodes_ptr, PriorityQueue** pq_ptr, Ha
         HashTable* new_running_jobs;
         JobList* new_completed_jobs;
         
-        if (load_state(arg1, &new_nodes, &new_pq, &new_running_jobs, &new_completed_jobs, &current_time, &next_job_id)) {
+        if (load_state(arg1, &new_nodes, &new_pq, &new_running_jobs, &new_completed_jobs, job_pool, &current_time, &next_job_id)) {
             // Update pointers
             *nodes_ptr = new_nodes;
             *pq_ptr = new_pq;
             *running_jobs_ptr = new_running_jobs;
             *completed_jobs_ptr = new_completed_jobs;
+            nl_set_policy(new_nodes, placement_policy);
+            jl_set_retention(new_completed_jobs, history_retention);
+            if (!pq_set_kind(new_pq, queue_kind) || !pq_set_aging(new_pq, aging_ticks)) {
+                printf("Warning: Failed to restore the pending queue settings\n");
+            }
             printf("State loaded from %s\n", arg1);
+            journal_checkpoint(arg1);
         } else {
             printf("Error: Failed to load state from %s\n", arg1);
-            // Reinitialize empty structures on failure
+            // Reinitialize empty structures on failure (load_state freed
+            // the ones it had built; jobs it allocated are dropped here)
+            jp_clear(job_pool);
             *nodes_ptr = nl_create(10);
+            nl_set_policy(*nodes_ptr, placement_policy);
             *pq_ptr = pq_create(10);
+            pq_set_kind(*pq_ptr, queue_kind);
+            pq_set_aging(*pq_ptr, aging_ticks);
             *running_jobs_ptr = ht_create(16);
-            *completed_jobs_ptr = jl_create();
+            *completed_jobs_ptr = jl_create(job_pool);
+            jl_set_retention(*completed_jobs_ptr, history_retention);
+            journal_command(line); // Replays to the same empty state
         }
         
     } else if (strcmp(command, "exit") == 0 || strcmp(command, "quit") == 0) {
@@ -241,13 +669,97 @@ int execute_command(char* line, NodeList** nodes_ptr, PriorityQueue** pq_ptr, Ha
         
     } else {
         printf("Unknown command: %s\n", command);
-        printf("Available commands: add-node, add-job, run-tick, status, save, load, exit\n");
+        printf("Available commands: add-node, add-job, submit-batch, cancel, set-priority, run-tick, run-ticks, run-until-idle, set-policy, set-queue, set-aging, set-backfill, set-threads, set-history, status, stats, latency, set-metrics-file, trace, replay, save, export, load, exit\n");
     }
     
     return 1; // Continue loop
 }
 
-int main(void) {
+// State handed to journal_replay_record during recovery
+typedef struct {
+    NodeList** nodes;
+    PriorityQueue** pq;
+    HashTable** running_jobs;
+    JobList** completed_jobs;
+} ReplayContext;
+
+static void journal_replay_record(const char* record, void* user_data) {
+    ReplayContext* ctx = (ReplayContext*)user_data;
+    char line[MAX_LINE_LENGTH];
+    snprintf(line, sizeof(line), "%s", record);
+    execute_command(line, ctx->nodes, ctx->pq, ctx->running_jobs, ctx->completed_jobs);
+}
+
+int main(int argc, char* argv[]) {
+    const char* journal_path = NULL;
+    int journal_group_size = DEFAULT_JOURNAL_GROUP_SIZE;
+    const char* metrics_path = NULL;
+    int metrics_interval = DEFAULT_METRICS_INTERVAL;
+    int backfill_depth = DEFAULT_BACKFILL_DEPTH;
+    int threads = 1;
+    
+    // Parse command-line options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            if (!nl_parse_policy(argv[++i], &placement_policy)) {
+                fprintf(stderr, "Error: Unknown placement policy '%s' (expected first-fit, best-fit, worst-fit or dot-product)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+            if (!pq_parse_kind(argv[++i], &queue_kind)) {
+                fprintf(stderr, "Error: Unknown queue kind '%s' (expected heap or bucket)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--aging") == 0 && i + 1 < argc) {
+            aging_ticks = atoi(argv[++i]);
+            if (aging_ticks < 0) {
+                fprintf(stderr, "Error: --aging must be non-negative\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--backfill") == 0 && i + 1 < argc) {
+            backfill_depth = atoi(argv[++i]);
+            if (backfill_depth < 0) {
+                fprintf(stderr, "Error: --backfill must be non-negative\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads < 1) {
+                fprintf(stderr, "Error: --threads must be at least 1\n");
+                return 1;
+            }
+            if (threads > 1 && !wp_enabled()) {
+                fprintf(stderr, "Error: --threads needs a build with threads enabled\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--history") == 0 && i + 1 < argc) {
+            history_retention = atoi(argv[++i]);
+            if (history_retention < 0) {
+                fprintf(stderr, "Error: --history must be non-negative\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+            journal_path = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-file") == 0 && i + 1 < argc) {
+            metrics_path = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc) {
+            metrics_interval = atoi(argv[++i]);
+            if (metrics_interval <= 0) {
+                fprintf(stderr, "Error: --metrics-interval must be positive\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--journal-sync") == 0 && i + 1 < argc) {
+            journal_group_size = atoi(argv[++i]);
+            if (journal_group_size <= 0) {
+                fprintf(stderr, "Error: --journal-sync must be positive\n");
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [--policy <first-fit|best-fit|worst-fit|dot-product>] [--queue <heap|bucket>] [--aging <ticks>] [--backfill <depth>] [--threads <n>] [--history <n>] [--journal <file> [--journal-sync <n>]] [--metrics-file <file> [--metrics-interval <ticks>]]\n", argv[0]);
+            return 1;
+        }
+    }
+    
     printf("=== Cloud Job Scheduler Simulator ===\n");
     printf("Type 'help' for available commands, or 'exit' to quit.\n\n");
     
@@ -255,12 +767,55 @@ int main(void) {
     NodeList* nodes = nl_create(10);
     PriorityQueue* pq = pq_create(10);
     HashTable* running_jobs = ht_create(16);
-    JobList* completed_jobs = jl_create();
+    job_pool = jp_create();
+    JobList* completed_jobs = jl_create(job_pool);
+    scheduler = scheduler_create();
     
-    if (!nodes || !pq || !running_jobs || !completed_jobs) {
+    if (!nodes || !pq || !running_jobs || !completed_jobs || !job_pool || !scheduler) {
         printf("Error: Failed to initialize data structures\n");
         return 1;
     }
+    if (metrics_path && !metrics_set_dump(scheduler, metrics_path, metrics_interval)) {
+        fprintf(stderr, "Error: --metrics-file needs a build with metrics enabled\n");
+        cleanup(nodes, pq, running_jobs, completed_jobs, job_pool);
+        scheduler_free(scheduler);
+        return 1;
+    }
+    scheduler_set_backfill_depth(scheduler, backfill_depth);
+    if (!scheduler_set_threads(scheduler, threads)) {
+        printf("Error: Failed to start %d threads\n", threads);
+        cleanup(nodes, pq, running_jobs, completed_jobs, job_pool);
+        scheduler_free(scheduler);
+        return 1;
+    }
+    nl_set_policy(nodes, placement_policy);
+    jl_set_retention(completed_jobs, history_retention);
+    if (!pq_set_kind(pq, queue_kind) || !pq_set_aging(pq, aging_ticks)) {
+        printf("Error: Failed to initialize the %s queue\n", pq_kind_name(queue_kind));
+        cleanup(nodes, pq, running_jobs, completed_jobs, job_pool);
+        scheduler_free(scheduler);
+        return 1;
+    }
+    
+    // Recover from the journal (latest snapshot + commands since), then keep
+    // appending to it
+    if (journal_path) {
+        FILE* existing = fopen(journal_path, "r");
+        if (existing) {
+            fclose(existing);
+            ReplayContext ctx = { &nodes, &pq, &running_jobs, &completed_jobs };
+            long long replayed = journal_replay(journal_path, journal_replay_record, &ctx);
+            printf("Recovered %lld journal records from %s\n\n", replayed, journal_path);
+        }
+        
+        journal = journal_open(journal_path, journal_group_size);
+        if (!journal) {
+            printf("Error: Failed to open journal %s\n", journal_path);
+            cleanup(nodes, pq, running_jobs, completed_jobs, job_pool);
+            scheduler_free(scheduler);
+            return 1;
+        }
+    }
     
     // Main command loop
     char line[MAX_LINE_LENGTH];
@@ -278,9 +833,28 @@ int main(void) {
             printf("\nAvailable commands:\n");
             printf("  add-node <cpu> <ram>     - Add a resource node\n");
             printf("  add-job <priority> <cpu> <ram> <duration> - Add a job\n");
+            printf("  submit-batch <filename>  - Add every job listed in a file\n");
+            printf("  cancel <job_id>          - Remove a pending job\n");
+            printf("  set-priority <job_id> <priority> - Change a pending job's priority\n");
             printf("  run-tick                 - Advance simulation by one time step\n");
+            printf("  run-ticks <n>            - Advance n time steps, skipping idle ticks\n");
+            printf("  run-until-idle           - Advance until no jobs are running\n");
+            printf("  set-policy <policy>      - Placement: first-fit, best-fit, worst-fit, dot-product\n");
+            printf("  set-queue <kind>         - Pending queue: heap or bucket (FIFO per priority level)\n");
+            printf("  set-aging <ticks>        - Waiting jobs gain one priority level per <ticks> (0 = off)\n");
+            printf("  set-backfill <depth>     - Jobs considered behind a blocked job (0 = head-of-line)\n");
+            printf("  set-threads <n>          - Threads collecting each tick's completions (1 = serial)\n");
+            printf("  set-history <n>          - Keep only the last n completed jobs in memory (0 = all)\n");
             printf("  status                   - Show current status\n");
-            printf("  save <filename>          - Save state to file\n");
+            printf("  stats                    - Show tick timings, placement counters and utilization\n");
+            printf("  latency [priority]       - Wait and turnaround percentiles per priority level\n");
+            printf("  set-metrics-file <file> <ticks> - Dump metrics in Prometheus format every <ticks> (off = stop)\n");
+            printf("  trace on [events]        - Record a scheduling timeline into a ring buffer (default %d events)\n", DEFAULT_TRACE_EVENTS);
+            printf("  trace dump <file>        - Write the timeline as Chrome trace-event JSON (trace off = stop)\n");
+            printf("  replay <file> [history]  - Replay an SWF or CSV workload trace and report makespan, utilization and waits\n");
+            printf("                             (keeps the last %d completed jobs unless history is set; 0 = all)\n", DEFAULT_REPLAY_HISTORY);
+            printf("  save <filename>          - Save state to a binary snapshot\n");
+            printf("  export <filename>        - Save state to a text file\n");
             printf("  load <filename>          - Load state from file\n");
             printf("  exit                     - Exit the program\n\n");
             continue;
@@ -293,7 +867,9 @@ int main(void) {
     }
     
     // Cleanup
-    cleanup(nodes, pq, running_jobs, completed_jobs);
+    journal_close(journal);
+    cleanup(nodes, pq, running_jobs, completed_jobs, job_pool);
+    scheduler_free(scheduler);
     
     printf("Goodbye!\n");
     return 0;
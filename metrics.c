@@ -0,0 +1,205 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // clock_gettime
+#endif
+
+#include "metrics.h"
+#include "scheduler.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static const char* const PHASE_NAMES[METRICS_PHASES] = { "admit", "complete", "place" };
+
+int metrics_enabled(void) {
+#ifdef SCHED_METRICS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+const char* metrics_phase_name(MetricsPhase phase) {
+    return phase >= 0 && phase < METRICS_PHASES ? PHASE_NAMES[phase] : "unknown";
+}
+
+long long metrics_now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (long long)(counter.QuadPart * (1000000000.0 / frequency.QuadPart));
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+void metrics_tick_begin(SchedulerMetrics* m) {
+    m->ticks++;
+    m->tick_completed = m->completed;
+    m->tick_placed = m->placed;
+    for (int i = 0; i < METRICS_PHASES; i++) {
+        m->phase_last_ns[i] = 0;
+    }
+}
+
+void metrics_phase_end(SchedulerMetrics* m, MetricsPhase phase, long long start_ns) {
+    long long elapsed = metrics_now_ns() - start_ns;
+    m->phase_ns[phase] += elapsed;
+    m->phase_last_ns[phase] = elapsed;
+    if (elapsed > m->phase_max_ns[phase]) {
+        m->phase_max_ns[phase] = elapsed;
+    }
+}
+
+void metrics_tick_end(Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, int current_time) {
+    SchedulerMetrics* m = &sched->metrics;
+    m->last_completed = (int)(m->completed - m->tick_completed);
+    m->last_placed = (int)(m->placed - m->tick_placed);
+
+    if (m->dump_interval > 0 && current_time - m->last_dump_time >= m->dump_interval) {
+        m->last_dump_time = current_time;
+        if (!metrics_write_prometheus(m->dump_path, sched, nodes, pq, running_jobs, current_time)) {
+            printf("Warning: Failed to write metrics to %s\n", m->dump_path);
+        }
+    }
+}
+
+// Fraction of all CPU and RAM in use across the cluster
+static void cluster_utilization(NodeList* nodes, double* cpu, double* ram) {
+    long long total_cpu = 0, used_cpu = 0, total_ram = 0, used_ram = 0;
+    for (int i = 0; nodes && i < nodes->size; i++) {
+        ResourceNode* node = nodes->nodes[i];
+        total_cpu += node->total_cpu;
+        used_cpu += node->total_cpu - node->available_cpu;
+        total_ram += node->total_ram;
+        used_ram += node->total_ram - node->available_ram;
+    }
+    *cpu = total_cpu > 0 ? (double)used_cpu / total_cpu : 0.0;
+    *ram = total_ram > 0 ? (double)used_ram / total_ram : 0.0;
+}
+
+static void write_metric(FILE* file, const char* name, const char* type, const char* help) {
+    fprintf(file, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+int metrics_write_prometheus(const char* path, const Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, int current_time) {
+    if (!metrics_enabled() || !path) {
+        return 0;
+    }
+
+    char temp_path[300];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE* file = fopen(temp_path, "w");
+    if (!file) {
+        return 0;
+    }
+
+    const SchedulerMetrics* m = &sched->metrics;
+    long long passes_run, passes_skipped;
+    double cpu, ram;
+    scheduler_pass_counts(sched, &passes_run, &passes_skipped);
+    cluster_utilization(nodes, &cpu, &ram);
+
+    write_metric(file, "scheduler_ticks_total", "counter", "Scheduler ticks run.");
+    fprintf(file, "scheduler_ticks_total %lld\n", m->ticks);
+    write_metric(file, "scheduler_phase_seconds_total", "counter", "Time spent in each tick phase.");
+    for (int i = 0; i < METRICS_PHASES; i++) {
+        fprintf(file, "scheduler_phase_seconds_total{phase=\"%s\"} %.9f\n", PHASE_NAMES[i], m->phase_ns[i] / 1e9);
+    }
+    write_metric(file, "scheduler_phase_max_seconds", "gauge", "Slowest single tick in each phase.");
+    for (int i = 0; i < METRICS_PHASES; i++) {
+        fprintf(file, "scheduler_phase_max_seconds{phase=\"%s\"} %.9f\n", PHASE_NAMES[i], m->phase_max_ns[i] / 1e9);
+    }
+    write_metric(file, "scheduler_jobs_completed_total", "counter", "Jobs completed.");
+    fprintf(file, "scheduler_jobs_completed_total %lld\n", m->completed);
+    write_metric(file, "scheduler_jobs_placed_total", "counter", "Jobs started on a node.");
+    fprintf(file, "scheduler_jobs_placed_total %lld\n", m->placed);
+    write_metric(file, "scheduler_placement_attempts_total", "counter", "Node searches during placement.");
+    fprintf(file, "scheduler_placement_attempts_total %lld\n", m->attempts);
+    write_metric(file, "scheduler_placement_failures_total", "counter", "Node searches that found no node.");
+    fprintf(file, "scheduler_placement_failures_total %lld\n", m->failures);
+    write_metric(file, "scheduler_placement_passes_total", "counter", "Placement passes by outcome.");
+    fprintf(file, "scheduler_placement_passes_total{result=\"run\"} %lld\n", passes_run);
+    fprintf(file, "scheduler_placement_passes_total{result=\"skipped\"} %lld\n", passes_skipped);
+    write_metric(file, "scheduler_out_of_order_starts_total", "counter", "Jobs started ahead of a waiting higher priority job.");
+    fprintf(file, "scheduler_out_of_order_starts_total %lld\n", scheduler_out_of_order_starts(sched));
+    write_metric(file, "scheduler_queue_depth", "gauge", "Pending jobs.");
+    fprintf(file, "scheduler_queue_depth %d\n", pq_size(pq));
+    write_metric(file, "scheduler_running_jobs", "gauge", "Running jobs.");
+    fprintf(file, "scheduler_running_jobs %d\n", ht_size(running_jobs));
+    write_metric(file, "scheduler_cluster_utilization", "gauge", "Fraction of cluster resources in use.");
+    fprintf(file, "scheduler_cluster_utilization{resource=\"cpu\"} %.6f\n", cpu);
+    fprintf(file, "scheduler_cluster_utilization{resource=\"ram\"} %.6f\n", ram);
+    write_metric(file, "scheduler_time", "gauge", "Current simulated time.");
+    fprintf(file, "scheduler_time %d\n", current_time);
+
+    int ok = !ferror(file);
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    if (ok) {
+        remove(path); // rename does not replace an existing file on Windows
+        ok = rename(temp_path, path) == 0;
+    }
+    if (!ok) {
+        remove(temp_path);
+    }
+    return ok;
+}
+
+int metrics_set_dump(Scheduler* sched, const char* path, int interval) {
+    if (!metrics_enabled() || !sched) {
+        return 0;
+    }
+
+    SchedulerMetrics* m = &sched->metrics;
+    if (!path || interval <= 0) {
+        m->dump_interval = 0;
+        return 1;
+    }
+    snprintf(m->dump_path, sizeof(m->dump_path), "%s", path);
+    m->dump_interval = interval;
+    m->last_dump_time = 0;
+    return 1;
+}
+
+void metrics_print(const Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, int current_time) {
+    if (!metrics_enabled()) {
+        printf("Metrics are disabled in this build (rebuild with SCHED_METRICS defined)\n");
+        return;
+    }
+
+    const SchedulerMetrics* m = &sched->metrics;
+    long long passes_run, passes_skipped;
+    double cpu, ram;
+    scheduler_pass_counts(sched, &passes_run, &passes_skipped);
+    cluster_utilization(nodes, &cpu, &ram);
+
+    printf("\n=== Scheduler Metrics (time %d) ===\n\n", current_time);
+    printf("Ticks: %lld\n", m->ticks);
+    printf("Phase timings (total / last tick / slowest tick, ms):\n");
+    for (int i = 0; i < METRICS_PHASES; i++) {
+        printf("  %-9s %10.3f / %8.3f / %8.3f\n", PHASE_NAMES[i],
+               m->phase_ns[i] / 1e6, m->phase_last_ns[i] / 1e6, m->phase_max_ns[i] / 1e6);
+    }
+    printf("Jobs completed: %lld (last tick: %d)\n", m->completed, m->last_completed);
+    printf("Jobs placed: %lld (last tick: %d)\n", m->placed, m->last_placed);
+    printf("Placement attempts: %lld (failures: %lld)\n", m->attempts, m->failures);
+    printf("Placement passes: %lld run, %lld skipped\n", passes_run, passes_skipped);
+    printf("Queue depth: %d\n", pq_size(pq));
+    printf("Running jobs: %d\n", ht_size(running_jobs));
+    printf("Cluster utilization: CPU %.1f%%, RAM %.1f%%\n", cpu * 100.0, ram * 100.0);
+    if (m->dump_interval > 0) {
+        printf("Prometheus dump: %s every %d ticks\n", m->dump_path, m->dump_interval);
+    }
+    printf("\n");
+}
@@ -0,0 +1,86 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "structs.h"
+
+// Scheduler instrumentation: per-phase tick timings (monotonic clock) and
+// placement counters, kept in each Scheduler. Built in when SCHED_METRICS is
+// defined (the default Makefile build, "make METRICS=0" leaves it out);
+// otherwise the hooks below compile to nothing and stats reports that
+// metrics are disabled
+
+typedef struct Scheduler Scheduler; // scheduler.h
+
+typedef enum {
+    METRICS_PHASE_ADMIT,    // Phase 0: submissions from the ring
+    METRICS_PHASE_COMPLETE, // Phase 1: completions
+    METRICS_PHASE_PLACE,    // Phase 2: placement
+    METRICS_PHASES
+} MetricsPhase;
+
+typedef struct {
+    long long ticks;
+    long long phase_ns[METRICS_PHASES];       // Total time per phase
+    long long phase_max_ns[METRICS_PHASES];   // Slowest single tick per phase
+    long long phase_last_ns[METRICS_PHASES];  // Most recent tick
+    long long completed;
+    long long placed;
+    long long attempts;     // Node searches during placement
+    long long failures;     // Searches that found no node
+    int last_completed;     // During the most recent tick
+    int last_placed;
+    long long tick_completed;   // Counters at the start of the current tick
+    long long tick_placed;
+    // Periodic Prometheus dump
+    char dump_path[256];
+    int dump_interval;      // Simulated ticks between dumps (0 = off)
+    int last_dump_time;
+} SchedulerMetrics;
+
+#ifdef SCHED_METRICS
+#define METRICS_NOW(var) long long var = metrics_now_ns()
+#define METRICS_PHASE_END(sched, phase, start) metrics_phase_end(&(sched)->metrics, (phase), (start))
+#define METRICS_COUNT(sched, field, n) ((sched)->metrics.field += (n))
+#define METRICS_ATTEMPT(sched, node_index) \
+    ((sched)->metrics.attempts++, (sched)->metrics.failures += (node_index) == -1)
+#define METRICS_TICK_BEGIN(sched) metrics_tick_begin(&(sched)->metrics)
+#define METRICS_TICK_END(sched, nodes, pq, running_jobs, current_time) \
+    metrics_tick_end((sched), (nodes), (pq), (running_jobs), (current_time))
+#else
+#define METRICS_NOW(var) ((void)0)
+#define METRICS_PHASE_END(sched, phase, start) ((void)0)
+#define METRICS_COUNT(sched, field, n) ((void)0)
+#define METRICS_ATTEMPT(sched, node_index) ((void)0)
+#define METRICS_TICK_BEGIN(sched) ((void)0)
+#define METRICS_TICK_END(sched, nodes, pq, running_jobs, current_time) ((void)0)
+#endif
+
+// Whether this build collects metrics
+int metrics_enabled(void);
+
+// Name of a tick phase ("admit", "complete", "place")
+const char* metrics_phase_name(MetricsPhase phase);
+
+// Monotonic clock in nanoseconds
+long long metrics_now_ns(void);
+
+// Tick bookkeeping used by the hooks above
+void metrics_tick_begin(SchedulerMetrics* m);
+void metrics_phase_end(SchedulerMetrics* m, MetricsPhase phase, long long start_ns);
+void metrics_tick_end(Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, int current_time);
+
+// Write every metric to path in Prometheus text exposition format, through
+// a temporary file renamed into place so readers never see a partial file
+// Returns 1 on success, 0 on failure (or when metrics are disabled)
+int metrics_write_prometheus(const char* path, const Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, int current_time);
+
+// Dump sched's metrics to path every interval simulated ticks (checked at
+// the end of each tick that runs); a NULL path or interval <= 0 turns
+// dumping off
+// Returns 1 on success, 0 if metrics are disabled
+int metrics_set_dump(Scheduler* sched, const char* path, int interval);
+
+// Print the metrics (for the stats command)
+void metrics_print(const Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, int current_time);
+
+#endif // METRICS_H
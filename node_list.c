@@ -1,6 +1,178 @@
 #include "node_list.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+// Summary of an empty leaf: never fits and never lowers a minimum
+static const CapacitySummary EMPTY_SUMMARY = { -1, -1, INT_MAX, INT_MAX };
+
+static void summary_merge(CapacitySummary* out, const CapacitySummary* a, const CapacitySummary* b) {
+    out->max_cpu = a->max_cpu > b->max_cpu ? a->max_cpu : b->max_cpu;
+    out->max_ram = a->max_ram > b->max_ram ? a->max_ram : b->max_ram;
+    out->min_cpu = a->min_cpu < b->min_cpu ? a->min_cpu : b->min_cpu;
+    out->min_ram = a->min_ram < b->min_ram ? a->min_ram : b->min_ram;
+}
+
+static void summary_leaf(CapacitySummary* out, ResourceNode* node) {
+    if (!node) {
+        *out = EMPTY_SUMMARY;
+        return;
+    }
+    out->max_cpu = out->min_cpu = node->available_cpu;
+    out->max_ram = out->min_ram = node->available_ram;
+}
+
+// Recompute the index entries on the path from leaf index up to the root
+static void index_update(NodeList* nl, int index) {
+    int pos = nl->leaves + index;
+    summary_leaf(&nl->index[pos], index < nl->size ? nl->nodes[index] : NULL);
+    
+    for (pos /= 2; pos >= 1; pos /= 2) {
+        summary_merge(&nl->index[pos], &nl->index[2 * pos], &nl->index[2 * pos + 1]);
+    }
+}
+
+// (Re)build the index so it has at least nl->capacity leaves
+static int index_build(NodeList* nl) {
+    int leaves = 1;
+    while (leaves < nl->capacity) {
+        leaves *= 2;
+    }
+    
+    CapacitySummary* index = (CapacitySummary*)malloc(2 * leaves * sizeof(CapacitySummary));
+    if (!index) {
+        return 0; // Failed to allocate
+    }
+    
+    for (int i = 0; i < leaves; i++) {
+        summary_leaf(&index[leaves + i], i < nl->size ? nl->nodes[i] : NULL);
+    }
+    for (int pos = leaves - 1; pos >= 1; pos--) {
+        summary_merge(&index[pos], &index[2 * pos], &index[2 * pos + 1]);
+    }
+    
+    free(nl->index);
+    nl->index = index;
+    nl->leaves = leaves;
+    return 1;
+}
+
+// --- Best-fit order (treap by free CPU, then free RAM, then position) ---
+
+// Marks an entry taken out of the order for a batch of releases
+#define FIT_DETACHED -2
+
+// Whether the node at position a comes before the one at b
+static int fit_before(NodeList* nl, int a, int b) {
+    FitEntry* x = &nl->fit[a];
+    FitEntry* y = &nl->fit[b];
+    if (x->cpu != y->cpu) return x->cpu < y->cpu;
+    if (x->ram != y->ram) return x->ram < y->ram;
+    return a < b;
+}
+
+// Recompute the subtree maximum of the entry at t from its key and children
+static void fit_pull(NodeList* nl, int t) {
+    FitEntry* e = &nl->fit[t];
+    e->max_ram = e->ram;
+    if (e->left != -1 && nl->fit[e->left].max_ram > e->max_ram) e->max_ram = nl->fit[e->left].max_ram;
+    if (e->right != -1 && nl->fit[e->right].max_ram > e->max_ram) e->max_ram = nl->fit[e->right].max_ram;
+}
+
+// Split the subtree at t into the entries before position pos and the rest
+static void fit_split(NodeList* nl, int t, int pos, int* left, int* right) {
+    if (t == -1) {
+        *left = *right = -1;
+        return;
+    }
+    if (fit_before(nl, t, pos)) {
+        fit_split(nl, nl->fit[t].right, pos, &nl->fit[t].right, right);
+        *left = t;
+    } else {
+        fit_split(nl, nl->fit[t].left, pos, left, &nl->fit[t].left);
+        *right = t;
+    }
+    fit_pull(nl, t);
+}
+
+// Join two subtrees where every entry of a comes before every entry of b
+static int fit_merge(NodeList* nl, int a, int b) {
+    if (a == -1) return b;
+    if (b == -1) return a;
+    if (nl->fit[a].priority > nl->fit[b].priority) {
+        nl->fit[a].right = fit_merge(nl, nl->fit[a].right, b);
+        fit_pull(nl, a);
+        return a;
+    }
+    nl->fit[b].left = fit_merge(nl, a, nl->fit[b].left);
+    fit_pull(nl, b);
+    return b;
+}
+
+static int fit_insert_at(NodeList* nl, int t, int pos) {
+    if (t == -1) {
+        return pos;
+    }
+    if (nl->fit[pos].priority > nl->fit[t].priority) {
+        fit_split(nl, t, pos, &nl->fit[pos].left, &nl->fit[pos].right);
+        fit_pull(nl, pos);
+        return pos;
+    }
+    if (fit_before(nl, pos, t)) {
+        nl->fit[t].left = fit_insert_at(nl, nl->fit[t].left, pos);
+    } else {
+        nl->fit[t].right = fit_insert_at(nl, nl->fit[t].right, pos);
+    }
+    fit_pull(nl, t);
+    return t;
+}
+
+static int fit_erase_at(NodeList* nl, int t, int pos) {
+    if (t == pos) {
+        return fit_merge(nl, nl->fit[t].left, nl->fit[t].right);
+    }
+    if (fit_before(nl, pos, t)) {
+        nl->fit[t].left = fit_erase_at(nl, nl->fit[t].left, pos);
+    } else {
+        nl->fit[t].right = fit_erase_at(nl, nl->fit[t].right, pos);
+    }
+    fit_pull(nl, t);
+    return t;
+}
+
+// Add the node at pos under its current free capacity
+static void fit_insert(NodeList* nl, int pos) {
+    FitEntry* e = &nl->fit[pos];
+    unsigned int h = (unsigned int)(pos + 1) * 0x9E3779B1u;
+    e->cpu = nl->nodes[pos]->available_cpu;
+    e->ram = nl->nodes[pos]->available_ram;
+    e->priority = h ^ (h >> 16); // Fixed per position, so runs are reproducible
+    e->left = -1;
+    e->right = -1;
+    fit_pull(nl, pos);
+    nl->fit_root = fit_insert_at(nl, nl->fit_root, pos);
+}
+
+// Remove the node at pos (before its free capacity changes)
+static void fit_remove(NodeList* nl, int pos) {
+    nl->fit_root = fit_erase_at(nl, nl->fit_root, pos);
+}
+
+static int fit_build(NodeList* nl) {
+    FitEntry* fit = (FitEntry*)realloc(nl->fit, nl->capacity * sizeof(FitEntry));
+    if (!fit) {
+        return 0; // Failed to allocate
+    }
+    
+    nl->fit = fit;
+    nl->fit_root = -1;
+    for (int i = 0; i < nl->size; i++) {
+        fit_insert(nl, i);
+    }
+    nl->fit_ready = 1;
+    return 1;
+}
 
 NodeList* nl_create(int capacity) {
     if (capacity <= 0) {
@@ -20,6 +192,27 @@ NodeList* nl_create(int capacity) {
     
     nl->size = 0;
     nl->capacity = capacity;
+    nl->index = NULL;
+    nl->leaves = 0;
+    nl->max_total_cpu = 0;
+    nl->max_total_ram = 0;
+    nl->policy = PLACEMENT_FIRST_FIT;
+    nl->capacity_epoch = 0;
+    nl->no_fit_count = 0;
+    nl->no_fit_epoch = 0;
+    nl->no_fit = (JobShape*)calloc(NL_NO_FIT_SLOTS, sizeof(JobShape));
+    nl->fit = NULL;
+    nl->fit_root = -1;
+    nl->fit_ready = 0;
+    nl->release_order = NULL;
+    nl->release_capacity = 0;
+    
+    if (!nl->no_fit || !index_build(nl)) {
+        free(nl->no_fit);
+        free(nl->nodes);
+        free(nl);
+        return NULL;
+    }
     return nl;
 }
 
@@ -32,6 +225,12 @@ static int nl_resize(NodeList* nl) {
     
     nl->nodes = new_nodes;
     nl->capacity = new_capacity;
+    nl->fit_ready = 0; // Rebuilt at the new capacity when next needed
+    
+    // Grow the capacity index along with the array
+    if (nl->capacity > nl->leaves) {
+        return index_build(nl);
+    }
     return 1;
 }
 
@@ -49,6 +248,14 @@ int nl_add(NodeList* nl, ResourceNode* node) {
     
     nl->nodes[nl->size] = node;
     nl->size++;
+    index_update(nl, nl->size - 1);
+    nl->capacity_epoch++;
+    
+    if (node->total_cpu > nl->max_total_cpu) nl->max_total_cpu = node->total_cpu;
+    if (node->total_ram > nl->max_total_ram) nl->max_total_ram = node->total_ram;
+    if (nl->fit_ready) {
+        fit_insert(nl, nl->size - 1);
+    }
     return 1; // Success
 }
 
@@ -59,31 +266,465 @@ ResourceNode* nl_get(NodeList* nl, int index) {
     return nl->nodes[index];
 }
 
+int nl_find_by_id(NodeList* nl, int node_id) {
+    if (!nl) {
+        return -1;
+    }
+    
+    // Node ids are assigned sequentially from 1, so try the direct slot first
+    ResourceNode* node = nl_get(nl, node_id - 1);
+    if (node && node->node_id == node_id) {
+        return node_id - 1;
+    }
+    
+    for (int i = 0; i < nl->size; i++) {
+        if (nl->nodes[i]->node_id == node_id) {
+            return i;
+        }
+    }
+    
+    return -1; // Not found
+}
+
 int nl_size(NodeList* nl) {
     return nl ? nl->size : 0;
 }
 
+// Leftmost leaf under pos whose node fits (cpu, ram), or -1.
+// Subtrees whose maximum CPU or RAM is too small are skipped entirely.
+static int index_find_first(NodeList* nl, int pos, int cpu, int ram) {
+    if (nl->index[pos].max_cpu < cpu || nl->index[pos].max_ram < ram) {
+        return -1;
+    }
+    if (pos >= nl->leaves) {
+        return pos - nl->leaves;
+    }
+    
+    int index = index_find_first(nl, 2 * pos, cpu, ram);
+    if (index != -1) {
+        return index;
+    }
+    return index_find_first(nl, 2 * pos + 1, cpu, ram);
+}
+
+// State of a branch-and-bound search for the highest-scoring fitting node
+typedef struct {
+    NodeList* nl;
+    int cpu;
+    int ram;
+    double cpu_scale;   // 1 / largest node CPU
+    double ram_scale;   // 1 / largest node RAM
+    int best_index;
+    double best_score;
+} PlacementSearch;
+
+// Score of a node with the given free capacity (higher is better), or, for a
+// subtree summary, an upper bound on the score of any fitting node within it
+static double placement_score(PlacementSearch* search, const CapacitySummary* s) {
+    double free_cpu, free_ram;
+    
+    switch (search->nl->policy) {
+        case PLACEMENT_BEST_FIT:
+            // Least capacity left over after placing the job; a fitting node
+            // has at least max(min, demand) free, which bounds the leftover
+            // (only used if the best-fit order cannot be allocated)
+            free_cpu = (s->min_cpu > search->cpu ? s->min_cpu : search->cpu) - search->cpu;
+            free_ram = (s->min_ram > search->ram ? s->min_ram : search->ram) - search->ram;
+            return -(free_cpu * search->cpu_scale + free_ram * search->ram_scale);
+        case PLACEMENT_WORST_FIT:
+            // Most capacity left over after placing the job
+            free_cpu = s->max_cpu - search->cpu;
+            free_ram = s->max_ram - search->ram;
+            return free_cpu * search->cpu_scale + free_ram * search->ram_scale;
+        case PLACEMENT_DOT_PRODUCT:
+        default:
+            // Alignment between the job's demand and the node's free capacity
+            return (search->cpu * search->cpu_scale) * (s->max_cpu * search->cpu_scale) +
+                   (search->ram * search->ram_scale) * (s->max_ram * search->ram_scale);
+    }
+}
+
+// Explore the subtree at pos, skipping subtrees that cannot fit the job or
+// whose score bound cannot beat the best node found so far (ties go to the
+// lowest index, so results do not depend on the visiting order)
+static void index_search(PlacementSearch* search, int pos, int first_leaf, int span, double bound) {
+    NodeList* nl = search->nl;
+    if (search->best_index != -1 &&
+        (bound < search->best_score ||
+         (bound == search->best_score && first_leaf > search->best_index))) {
+        return;
+    }
+    
+    if (pos >= nl->leaves) {
+        int index = pos - nl->leaves;
+        if (search->best_index == -1 || bound > search->best_score ||
+            (bound == search->best_score && index < search->best_index)) {
+            search->best_index = index;
+            search->best_score = bound;
+        }
+        return;
+    }
+    
+    int left = 2 * pos;
+    int right = 2 * pos + 1;
+    int half = span / 2;
+    int fits_left = nl->index[left].max_cpu >= search->cpu && nl->index[left].max_ram >= search->ram;
+    int fits_right = nl->index[right].max_cpu >= search->cpu && nl->index[right].max_ram >= search->ram;
+    double left_bound = fits_left ? placement_score(search, &nl->index[left]) : 0.0;
+    double right_bound = fits_right ? placement_score(search, &nl->index[right]) : 0.0;
+    
+    // Visit the more promising child first so the other is more likely pruned
+    if (fits_left && fits_right && right_bound > left_bound) {
+        index_search(search, right, first_leaf + half, half, right_bound);
+        index_search(search, left, first_leaf, half, left_bound);
+    } else {
+        if (fits_left) index_search(search, left, first_leaf, half, left_bound);
+        if (fits_right) index_search(search, right, first_leaf + half, half, right_bound);
+    }
+}
+
+// First node in best-fit order under t with at least cpu free CPU that fits
+// ram, skipping the node at excluded, or -1. The CPU bound cuts the order in
+// two, so only one path is followed besides subtrees skipped for their RAM.
+static int fit_find_first(NodeList* nl, int t, int cpu, int ram, int excluded) {
+    while (t != -1 && nl->fit[t].max_ram >= ram) {
+        FitEntry* e = &nl->fit[t];
+        if (e->cpu < cpu) {
+            t = e->right; // This node and its left subtree have too little CPU
+            continue;
+        }
+        
+        int index = fit_find_first(nl, e->left, cpu, ram, excluded);
+        if (index != -1) {
+            return index;
+        }
+        if (t != excluded && e->ram >= ram) {
+            return t;
+        }
+        t = e->right;
+    }
+    return -1;
+}
+
+// Best fit: the fitting node left with the least normalized capacity (free
+// CPU over the largest node's CPU plus the same for RAM), lowest index on ties
+static int fit_find_best(NodeList* nl, int cpu, int ram, int excluded) {
+    long long cpu_weight = nl->max_total_ram > 0 ? nl->max_total_ram : 1;
+    long long ram_weight = nl->max_total_cpu > 0 ? nl->max_total_cpu : 1;
+    int best_index = -1;
+    long long best_cost = 0;
+    
+    // The first fitting node of each free-CPU level is that level's best;
+    // stop once even a level's CPU alone (with the least RAM the job allows)
+    // costs more than the best node found
+    int level = cpu;
+    for (;;) {
+        int index = fit_find_first(nl, nl->fit_root, level, ram, excluded);
+        if (index == -1) {
+            break;
+        }
+        FitEntry* e = &nl->fit[index];
+        long long cost = e->cpu * cpu_weight + e->ram * ram_weight;
+        if (best_index == -1 || cost < best_cost || (cost == best_cost && index < best_index)) {
+            best_index = index;
+            best_cost = cost;
+        }
+        if (e->cpu == INT_MAX || (e->cpu + 1) * cpu_weight + ram * ram_weight > best_cost) {
+            break;
+        }
+        level = e->cpu + 1;
+    }
+    return best_index;
+}
+
+// Search the index for a node that fits (cpu, ram) under the list's policy,
+// never picking the node at excluded (-1 = none; its leaf in the capacity
+// index must already be hidden)
+static int index_find(NodeList* nl, int cpu, int ram, int excluded) {
+    if (nl->index[1].max_cpu < cpu || nl->index[1].max_ram < ram) {
+        return -1; // No node can fit the job right now
+    }
+    
+    if (nl->policy == PLACEMENT_FIRST_FIT) {
+        // First fit: the lowest-index node that can fit the job
+        return index_find_first(nl, 1, cpu, ram);
+    }
+    if (nl->policy == PLACEMENT_BEST_FIT && (nl->fit_ready || fit_build(nl))) {
+        // Subtree minima cannot bound the leftover in a partly full cluster
+        // (some node is nearly always empty), so best fit has its own order
+        return fit_find_best(nl, cpu, ram, excluded);
+    }
+    
+    PlacementSearch search;
+    search.nl = nl;
+    search.cpu = cpu;
+    search.ram = ram;
+    search.cpu_scale = 1.0 / (nl->max_total_cpu > 0 ? nl->max_total_cpu : 1);
+    search.ram_scale = 1.0 / (nl->max_total_ram > 0 ? nl->max_total_ram : 1);
+    search.best_index = -1;
+    search.best_score = 0.0;
+    
+    index_search(&search, 1, 0, nl->leaves, placement_score(&search, &nl->index[1]));
+    return search.best_index;
+}
+
+// Slot of a shape in the no-fit set: where it is, or the empty slot where it
+// would go
+static int no_fit_slot(NodeList* nl, int cpu, int ram) {
+    unsigned int h = (unsigned int)cpu * 0x9E3779B1u ^ (unsigned int)ram * 0x85EBCA77u;
+    int mask = NL_NO_FIT_SLOTS - 1;
+    int slot = (int)((h ^ (h >> 15)) & mask);
+    while (nl->no_fit[slot].cpu != 0 &&
+           (nl->no_fit[slot].cpu != cpu || nl->no_fit[slot].ram != ram)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
 int nl_find_available_node(NodeList* nl, Job* job) {
-    if (!nl || !job) {
+    if (!nl || !job || nl->size == 0) {
         return -1;
     }
     
-    // Search through the dynamic array for a node that can fit the job
-    for (int i = 0; i < nl->size; i++) {
-        ResourceNode* node = nl->nodes[i];
-        if (node->available_cpu >= job->required_cpu &&
-            node->available_ram >= job->required_ram) {
-            return i; // Found an available node
+    int cpu = job->required_cpu;
+    int ram = job->required_ram;
+    
+    // Forget failed shapes once any node has gained capacity
+    if (nl->no_fit_epoch != nl->capacity_epoch) {
+        memset(nl->no_fit, 0, NL_NO_FIT_SLOTS * sizeof(JobShape));
+        nl->no_fit_count = 0;
+        nl->no_fit_epoch = nl->capacity_epoch;
+    }
+    
+    int slot = no_fit_slot(nl, cpu, ram);
+    if (nl->no_fit[slot].cpu != 0) {
+        return -1; // Same shape already failed
+    }
+    
+    int index = index_find(nl, cpu, ram, -1);
+    if (index == -1 && cpu > 0) {
+        // Remember the failure, starting over when the set is 3/4 full
+        if (nl->no_fit_count >= NL_NO_FIT_SLOTS * 3 / 4) {
+            memset(nl->no_fit, 0, NL_NO_FIT_SLOTS * sizeof(JobShape));
+            nl->no_fit_count = 0;
+            slot = no_fit_slot(nl, cpu, ram);
+        }
+        nl->no_fit[slot].cpu = cpu;
+        nl->no_fit[slot].ram = ram;
+        nl->no_fit_count++;
+    }
+    return index;
+}
+
+int nl_known_no_fit(NodeList* nl, Job* job) {
+    if (!nl || !job || nl->no_fit_epoch != nl->capacity_epoch) {
+        return 0; // Unknown, or the cache is stale
+    }
+    return nl->no_fit[no_fit_slot(nl, job->required_cpu, job->required_ram)].cpu != 0;
+}
+
+int nl_find_available_node_except(NodeList* nl, Job* job, int excluded) {
+    if (!nl || !job || excluded < 0 || excluded >= nl->size) {
+        return nl_find_available_node(nl, job);
+    }
+    
+    // Hide the excluded node's leaf while searching, then restore it. The
+    // no-fit set is neither consulted nor filled: results here only hold
+    // for the other nodes
+    int pos = nl->leaves + excluded;
+    nl->index[pos] = EMPTY_SUMMARY;
+    for (pos /= 2; pos >= 1; pos /= 2) {
+        summary_merge(&nl->index[pos], &nl->index[2 * pos], &nl->index[2 * pos + 1]);
+    }
+    int index = index_find(nl, job->required_cpu, job->required_ram, excluded);
+    index_update(nl, excluded);
+    return index;
+}
+
+int nl_has_free_capacity(NodeList* nl) {
+    if (!nl || nl->size == 0) {
+        return 0;
+    }
+    
+    // The root of the capacity index summarizes every node
+    return nl->index[1].max_cpu > 0 && nl->index[1].max_ram > 0;
+}
+
+void nl_reserve(NodeList* nl, int index, int cpu, int ram) {
+    ResourceNode* node = nl_get(nl, index);
+    if (!node) {
+        return;
+    }
+    
+    if (nl->fit_ready) {
+        fit_remove(nl, index);
+    }
+    node->available_cpu -= cpu;
+    node->available_ram -= ram;
+    index_update(nl, index);
+    if (nl->fit_ready) {
+        fit_insert(nl, index);
+    }
+}
+
+void nl_release(NodeList* nl, int index, int cpu, int ram) {
+    ResourceNode* node = nl_get(nl, index);
+    if (!node) {
+        return;
+    }
+    
+    if (nl->fit_ready) {
+        fit_remove(nl, index);
+    }
+    node->available_cpu += cpu;
+    node->available_ram += ram;
+    index_update(nl, index);
+    if (nl->fit_ready) {
+        fit_insert(nl, index);
+    }
+    nl->capacity_epoch++;
+}
+
+// Batches smaller than this are applied on the caller one release at a time
+#define NL_PARALLEL_RELEASES 64
+
+typedef struct {
+    NodeList* nl;
+    int chunks;             // Chunk count (at most NL_RELEASE_CHUNKS and nl->leaves)
+    int start[NL_RELEASE_CHUNKS + 1]; // Chunk c's releases in release_order
+} ReleaseBatch;
+
+// Apply one chunk's releases and refresh the index below the chunk's root.
+// Chunks cover disjoint nodes and subtrees, so they can run concurrently
+static void release_chunk_task(int chunk, void* arg) {
+    ReleaseBatch* batch = (ReleaseBatch*)arg;
+    NodeList* nl = batch->nl;
+    for (int i = batch->start[chunk]; i < batch->start[chunk + 1]; i++) {
+        NodeRelease* release = &nl->release_order[i];
+        ResourceNode* node = nl->nodes[release->index];
+        node->available_cpu += release->cpu;
+        node->available_ram += release->ram;
+        
+        int pos = nl->leaves + release->index;
+        summary_leaf(&nl->index[pos], node);
+        for (pos /= 2; pos >= batch->chunks; pos /= 2) {
+            summary_merge(&nl->index[pos], &nl->index[2 * pos], &nl->index[2 * pos + 1]);
+        }
+    }
+}
+
+static int release_reserve(NodeList* nl, int count) {
+    if (count <= nl->release_capacity) {
+        return 1;
+    }
+    NodeRelease* order = (NodeRelease*)realloc(nl->release_order, count * sizeof(NodeRelease));
+    if (!order) {
+        return 0;
+    }
+    nl->release_order = order;
+    nl->release_capacity = count;
+    return 1;
+}
+
+void nl_release_batch(NodeList* nl, const NodeRelease* releases, int count, WorkerPool* workers) {
+    if (!nl || !releases || count <= 0) {
+        return;
+    }
+    
+    if (wp_threads(workers) <= 1 || count < NL_PARALLEL_RELEASES || !release_reserve(nl, count)) {
+        for (int i = 0; i < count; i++) {
+            nl_release(nl, releases[i].index, releases[i].cpu, releases[i].ram);
+        }
+        return;
+    }
+    
+    // Group the releases by chunk (counting sort, stable)
+    ReleaseBatch batch;
+    batch.nl = nl;
+    batch.chunks = nl->leaves < NL_RELEASE_CHUNKS ? nl->leaves : NL_RELEASE_CHUNKS;
+    int chunk_size = nl->leaves / batch.chunks;
+    int fill[NL_RELEASE_CHUNKS] = { 0 };
+    for (int i = 0; i < count; i++) {
+        fill[releases[i].index / chunk_size]++;
+    }
+    batch.start[0] = 0;
+    for (int c = 0; c < batch.chunks; c++) {
+        batch.start[c + 1] = batch.start[c] + fill[c];
+        fill[c] = batch.start[c];
+    }
+    for (int i = 0; i < count; i++) {
+        nl->release_order[fill[releases[i].index / chunk_size]++] = releases[i];
+    }
+    
+    // Take the touched nodes out of the best-fit order under their old keys
+    // (a node released twice is taken out once)
+    if (nl->fit_ready) {
+        for (int i = 0; i < count; i++) {
+            int index = nl->release_order[i].index;
+            if (nl->fit[index].left != FIT_DETACHED) {
+                fit_remove(nl, index);
+                nl->fit[index].left = FIT_DETACHED;
+            }
+        }
+    }
+    
+    wp_run(workers, batch.chunks, release_chunk_task, &batch);
+    for (int pos = batch.chunks - 1; pos >= 1; pos--) {
+        summary_merge(&nl->index[pos], &nl->index[2 * pos], &nl->index[2 * pos + 1]);
+    }
+    
+    if (nl->fit_ready) {
+        for (int i = 0; i < count; i++) {
+            int index = nl->release_order[i].index;
+            if (nl->fit[index].left == FIT_DETACHED) {
+                fit_insert(nl, index);
+            }
+        }
+    }
+    nl->capacity_epoch++;
+}
+
+void nl_set_policy(NodeList* nl, PlacementPolicy policy) {
+    if (nl) {
+        nl->policy = policy;
+        if (policy != PLACEMENT_BEST_FIT) {
+            nl->fit_ready = 0; // Stop maintaining the best-fit order
         }
     }
+}
+
+static const char* const POLICY_NAMES[] = {
+    "first-fit", "best-fit", "worst-fit", "dot-product"
+};
+
+const char* nl_policy_name(PlacementPolicy policy) {
+    if ((int)policy < 0 || (int)policy >= (int)(sizeof(POLICY_NAMES) / sizeof(POLICY_NAMES[0]))) {
+        return "unknown";
+    }
+    return POLICY_NAMES[policy];
+}
+
+int nl_parse_policy(const char* name, PlacementPolicy* policy) {
+    if (!name || !policy) {
+        return 0;
+    }
     
-    return -1; // No available node found
+    for (int i = 0; i < (int)(sizeof(POLICY_NAMES) / sizeof(POLICY_NAMES[0])); i++) {
+        if (strcmp(name, POLICY_NAMES[i]) == 0) {
+            *policy = (PlacementPolicy)i;
+            return 1;
+        }
+    }
+    return 0; // Unknown policy name
 }
 
 void nl_free(NodeList* nl) {
     if (nl) {
+        free(nl->index);
+        free(nl->fit);
+        free(nl->release_order);
+        free(nl->no_fit);
         free(nl->nodes);
         free(nl);
     }
 }
-
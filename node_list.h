@@ -2,6 +2,7 @@
 #define NODE_LIST_H
 
 #include "structs.h"
+#include "worker_pool.h"
 
 // Create a new node list with initial capacity
 NodeList* nl_create(int capacity);
@@ -12,13 +13,56 @@ int nl_add(NodeList* nl, ResourceNode* node);
 // Get a node by index
 ResourceNode* nl_get(NodeList* nl, int index);
 
+// Find a node by its node_id
+// Returns the index of the node, or -1 if no node has that id
+int nl_find_by_id(NodeList* nl, int node_id);
+
 // Get the size of the list
 int nl_size(NodeList* nl);
 
-// Find an available node that can fit the job requirements
+// Find an available node that can fit the job requirements, chosen by the
+// list's placement policy (ties go to the lowest index)
+// Uses the capacity index, so the lookup is O(log n) in the common case;
+// best fit uses its own order by free CPU and RAM, built on first use
 // Returns the index of the node, or -1 if no node is available
+// A shape (cpu, ram) that found no node is answered from a cache in O(1)
+// until some node gains capacity, so identical blocked jobs cost one search
 int nl_find_available_node(NodeList* nl, Job* job);
 
+// Whether the job's shape is already known to fit on no node (answered from
+// the no-fit cache in O(1), without searching)
+int nl_known_no_fit(NodeList* nl, Job* job);
+
+// Same as nl_find_available_node, but never picks the node at excluded
+int nl_find_available_node_except(NodeList* nl, Job* job, int excluded);
+
+// Quick O(1) check before searching: returns 0 when no job can fit anywhere
+// (every node is out of CPU, or every node is out of RAM)
+int nl_has_free_capacity(NodeList* nl);
+
+// Deduct resources from the node at index and update the capacity index
+// Node resources must only be changed through these functions once the
+// node has been added to the list
+void nl_reserve(NodeList* nl, int index, int cpu, int ram);
+
+// Return resources to the node at index and update the capacity index
+void nl_release(NodeList* nl, int index, int cpu, int ram);
+
+// Apply count releases at once, as if by nl_release in any order. Large
+// batches are split by node position and applied on workers' threads (NULL =
+// on the caller); the best-fit order, if built, is then updated on the caller
+void nl_release_batch(NodeList* nl, const NodeRelease* releases, int count, WorkerPool* workers);
+
+// Select the placement policy used by nl_find_available_node
+void nl_set_policy(NodeList* nl, PlacementPolicy policy);
+
+// Name of a placement policy ("first-fit", "best-fit", ...)
+const char* nl_policy_name(PlacementPolicy policy);
+
+// Parse a placement policy name
+// Returns 1 and stores the policy on success, 0 if the name is unknown
+int nl_parse_policy(const char* name, PlacementPolicy* policy);
+
 // Free the node list (does not free nodes themselves)
 void nl_free(NodeList* nl);
 
@@ -1,7 +1,588 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // mmap, fstat
+#endif
+
 #include "persistence.h"
+#include "journal.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// --- Binary snapshot format ---
+// [SnapshotHeader][SnapshotSection x section_count][section data ...]
+// All integers are fixed-width in host byte order; every section starts at
+// an 8-byte aligned offset and holds `count` records of `record_size` bytes.
+// The checksum is FNV-1a (64-bit) over everything after the header.
+// Version 2 added the latency histogram section; version 1 snapshots still
+// load, with the histograms rebuilt from the retained completed jobs.
+#define SNAPSHOT_MAGIC "CJSSNAP\0"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_MIN_VERSION 1
+
+enum {
+    SECTION_NODES = 1,
+    SECTION_PENDING = 2,
+    SECTION_RUNNING = 3,
+    SECTION_COMPLETED = 4,
+    SECTION_COMPLETED_STATS = 5,
+    SECTION_LATENCY = 6,        // Since version 2
+    SECTION_COUNT = 6
+};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t section_count;
+    int32_t current_time;
+    int32_t next_job_id;
+    uint64_t checksum;
+    uint64_t file_size;
+} SnapshotHeader;
+
+typedef struct {
+    uint32_t type;
+    uint32_t record_size;
+    uint64_t offset;
+    uint64_t count;
+} SnapshotSection;
+
+typedef struct {
+    int32_t node_id;
+    int32_t total_cpu;
+    int32_t total_ram;
+    int32_t available_cpu;
+    int32_t available_ram;
+} NodeRecord;
+
+typedef struct {
+    int32_t job_id;
+    int32_t priority;
+    int32_t required_cpu;
+    int32_t required_ram;
+    int32_t duration;
+    int32_t status;
+    int32_t arrival_time;
+    int32_t start_time;
+    int32_t finish_time;
+    int32_t node_id;    // Node of a running job, -1 otherwise
+} JobRecord;
+
+typedef struct {
+    int64_t completed;
+    int64_t total_wait;
+    int64_t total_turnaround;
+    int64_t cpu_ticks;
+    int64_t ram_ticks;
+} StatsRecord;
+
+// One non-empty latency histogram
+typedef struct {
+    int32_t latency_class;
+    int32_t kind;           // LATENCY_KIND_*
+    int32_t min;
+    int32_t max;
+    int64_t count;
+    int64_t sum;
+    int64_t buckets[HISTOGRAM_BUCKETS];
+} HistogramRecord;
+
+enum { LATENCY_KIND_WAIT = 0, LATENCY_KIND_TURNAROUND = 1, LATENCY_KINDS = 2 };
+static const char* const LATENCY_KIND_NAMES[LATENCY_KINDS] = { "wait", "turnaround" };
+
+static Histogram* latency_histogram(LatencyStats* stats, int kind, int latency_class) {
+    if (latency_class < 0 || latency_class >= LATENCY_CLASSES) {
+        return NULL;
+    }
+    if (kind == LATENCY_KIND_WAIT) {
+        return &stats->wait[latency_class];
+    }
+    return kind == LATENCY_KIND_TURNAROUND ? &stats->turnaround[latency_class] : NULL;
+}
+
+static int latency_kind(const char* name) {
+    for (int kind = 0; kind < LATENCY_KINDS; kind++) {
+        if (strcmp(name, LATENCY_KIND_NAMES[kind]) == 0) {
+            return kind;
+        }
+    }
+    return -1;
+}
+
+static int latency_histogram_count(LatencyStats* stats) {
+    int count = 0;
+    for (int kind = 0; kind < LATENCY_KINDS; kind++) {
+        for (int i = 0; i < LATENCY_CLASSES; i++) {
+            count += latency_histogram(stats, kind, i)->count > 0;
+        }
+    }
+    return count;
+}
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// Buffered writer that checksums everything it writes
+#define SNAPSHOT_BUFFER_SIZE (64 * 1024)
+
+typedef struct {
+    FILE* file;
+    unsigned char buffer[SNAPSHOT_BUFFER_SIZE];
+    size_t used;
+    uint64_t offset;    // Bytes written so far, including the header
+    uint64_t checksum;
+    int failed;
+} SnapshotWriter;
+
+static void writer_flush(SnapshotWriter* w) {
+    if (w->used > 0 && fwrite(w->buffer, 1, w->used, w->file) != w->used) {
+        w->failed = 1;
+    }
+    w->used = 0;
+}
+
+static void writer_put(SnapshotWriter* w, const void* data, size_t length) {
+    w->checksum = fnv1a(w->checksum, data, length);
+    w->offset += length;
+    
+    const unsigned char* bytes = (const unsigned char*)data;
+    while (length > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - w->used;
+        if (chunk > length) chunk = length;
+        memcpy(w->buffer + w->used, bytes, chunk);
+        w->used += chunk;
+        bytes += chunk;
+        length -= chunk;
+        if (w->used == SNAPSHOT_BUFFER_SIZE) {
+            writer_flush(w);
+        }
+    }
+}
+
+static void writer_align(SnapshotWriter* w) {
+    static const unsigned char zeros[8] = {0};
+    if (w->offset % 8 != 0) {
+        writer_put(w, zeros, 8 - w->offset % 8);
+    }
+}
+
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+static void job_to_record(const Job* job, int node_id, JobRecord* record) {
+    record->job_id = job->job_id;
+    record->priority = job->priority;
+    record->required_cpu = job->required_cpu;
+    record->required_ram = job->required_ram;
+    record->duration = job->duration;
+    record->status = job->status;
+    record->arrival_time = job->arrival_time;
+    record->start_time = job->start_time;
+    record->finish_time = job->finish_time;
+    record->node_id = node_id;
+}
+
+static void record_to_job(const JobRecord* record, Job* job) {
+    job->job_id = record->job_id;
+    job->priority = record->priority;
+    job->required_cpu = record->required_cpu;
+    job->required_ram = record->required_ram;
+    job->duration = record->duration;
+    job->status = record->status;
+    job->arrival_time = record->arrival_time;
+    job->start_time = record->start_time;
+    job->finish_time = record->finish_time;
+}
+
+int save_snapshot(const char* filename, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int current_time, int next_job_id) {
+    if (!filename || !nodes || !pq || !running_jobs || !completed_jobs) {
+        return 0; // Error
+    }
+    
+    SnapshotWriter* w = (SnapshotWriter*)malloc(sizeof(SnapshotWriter));
+    if (!w) {
+        return 0;
+    }
+    
+    // Write beside the target and rename over it once synced, so a crash
+    // never leaves a torn snapshot in place of the previous one
+    char temp_path[512];
+    if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", filename) >= (int)sizeof(temp_path)) {
+        free(w);
+        return 0; // Path too long
+    }
+    w->file = fopen(temp_path, "wb");
+    if (!w->file) {
+        free(w);
+        return 0; // Failed to open file
+    }
+    
+    // Lay out the sections
+    SnapshotSection sections[SECTION_COUNT];
+    uint64_t counts[SECTION_COUNT] = {
+        (uint64_t)nl_size(nodes), (uint64_t)pq_size(pq), (uint64_t)ht_size(running_jobs),
+        (uint64_t)jl_size(completed_jobs), 1, (uint64_t)latency_histogram_count(completed_jobs->latency)
+    };
+    uint32_t sizes[SECTION_COUNT] = {
+        sizeof(NodeRecord), sizeof(JobRecord), sizeof(JobRecord), sizeof(JobRecord), sizeof(StatsRecord),
+        sizeof(HistogramRecord)
+    };
+    uint64_t offset = align8(sizeof(SnapshotHeader) + sizeof(sections));
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        sections[i].type = (uint32_t)(SECTION_NODES + i);
+        sections[i].record_size = sizes[i];
+        sections[i].offset = offset;
+        sections[i].count = counts[i];
+        offset = align8(offset + counts[i] * sizes[i]);
+    }
+    
+    // Reserve space for the header; it is written last, once the checksum is known
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    w->used = 0;
+    w->failed = fwrite(&header, sizeof(header), 1, w->file) != 1;
+    w->offset = sizeof(header);
+    w->checksum = FNV_OFFSET_BASIS;
+    writer_put(w, sections, sizeof(sections));
+    
+    // Nodes
+    writer_align(w);
+    for (int i = 0; i < nl_size(nodes); i++) {
+        ResourceNode* node = nl_get(nodes, i);
+        NodeRecord record = { node->node_id, node->total_cpu, node->total_ram,
+                              node->available_cpu, node->available_ram };
+        writer_put(w, &record, sizeof(record));
+    }
+    
+    // Pending jobs: a heap is written straight from its array (already in
+    // heap order); buckets are walked in queue order, which is also a
+    // valid heap order
+    writer_align(w);
+    if (pq_kind(pq) == PQ_KIND_HEAP) {
+        for (int i = 0; i < pq_size(pq); i++) {
+            JobRecord record;
+            job_to_record(pq->jobs[i], -1, &record);
+            writer_put(w, &record, sizeof(record));
+        }
+    } else {
+        PQIterator it;
+        Job* job;
+        pq_iter_init(&it, pq);
+        while ((job = pq_iter_next(&it)) != NULL) {
+            JobRecord record;
+            job_to_record(job, -1, &record);
+            writer_put(w, &record, sizeof(record));
+        }
+        if (it.failed) {
+            w->failed = 1;
+        }
+        pq_iter_free(&it);
+    }
+    
+    // Running jobs
+    writer_align(w);
+    for (int i = 0; i < running_jobs->capacity; i++) {
+        HashNode* entry = &running_jobs->table[i];
+        if (!entry->job) {
+            continue; // Empty slot
+        }
+        JobRecord record;
+        job_to_record(entry->job, entry->node_id, &record);
+        writer_put(w, &record, sizeof(record));
+    }
+    
+    // Completed jobs (retained window) and the aggregates over all of them
+    writer_align(w);
+    for (int i = 0; i < jl_size(completed_jobs); i++) {
+        JobRecord record;
+        job_to_record(jl_get(completed_jobs, i), -1, &record);
+        writer_put(w, &record, sizeof(record));
+    }
+    writer_align(w);
+    StatsRecord stats = { completed_jobs->stats.completed, completed_jobs->stats.total_wait,
+                          completed_jobs->stats.total_turnaround, completed_jobs->stats.cpu_ticks,
+                          completed_jobs->stats.ram_ticks };
+    writer_put(w, &stats, sizeof(stats));
+    
+    // Non-empty latency histograms
+    writer_align(w);
+    for (int kind = 0; kind < LATENCY_KINDS; kind++) {
+        for (int i = 0; i < LATENCY_CLASSES; i++) {
+            Histogram* h = latency_histogram(completed_jobs->latency, kind, i);
+            if (h->count == 0) {
+                continue;
+            }
+            HistogramRecord record;
+            record.latency_class = i;
+            record.kind = kind;
+            record.min = h->min;
+            record.max = h->max;
+            record.count = h->count;
+            record.sum = h->sum;
+            memcpy(record.buckets, h->buckets, sizeof(record.buckets));
+            writer_put(w, &record, sizeof(record));
+        }
+    }
+    writer_flush(w);
+    
+    // Now write the real header
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.section_count = SECTION_COUNT;
+    header.current_time = current_time;
+    header.next_job_id = next_job_id;
+    header.checksum = w->checksum;
+    header.file_size = w->offset;
+    if (fseek(w->file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, w->file) != 1) {
+        w->failed = 1;
+    }
+    
+    int ok = !w->failed;
+    if (!sync_file_close(w->file)) {
+        ok = 0;
+    }
+    free(w);
+    if (!ok || !replace_file(temp_path, filename)) {
+        remove(temp_path);
+        return 0;
+    }
+    return 1;
+}
+
+// Map a whole file read-only; falls back to reading it into memory where
+// mmap is unavailable. Returns NULL on failure.
+static const unsigned char* map_file(const char* filename, size_t* size) {
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+    *size = (size_t)st.st_size;
+    return (const unsigned char*)data;
+#else
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = length > 0 ? (unsigned char*)malloc((size_t)length) : NULL;
+    if (!data || fread(data, 1, (size_t)length, file) != (size_t)length) {
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    *size = (size_t)length;
+    return data;
+#endif
+}
+
+static void unmap_file(const unsigned char* data, size_t size) {
+#ifndef _WIN32
+    munmap((void*)data, size);
+#else
+    (void)size;
+    free((void*)data);
+#endif
+}
+
+// Locate a section of the given type, checking that it lies within the file
+static const SnapshotSection* find_section(const SnapshotSection* sections, uint32_t count, uint32_t type, uint32_t record_size, size_t file_size) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (sections[i].type != type) {
+            continue;
+        }
+        if (sections[i].record_size != record_size || sections[i].offset > file_size ||
+            sections[i].count > (file_size - sections[i].offset) / record_size) {
+            return NULL; // Corrupt section
+        }
+        return &sections[i];
+    }
+    return NULL; // Missing section
+}
+
+// Free structures built by a load that failed part-way (any may be NULL)
+static void free_loaded_state(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs) {
+    for (int i = 0; i < nl_size(nodes); i++) {
+        free(nl_get(nodes, i));
+    }
+    nl_free(nodes);
+    pq_free(pq);
+    ht_free(running_jobs);
+    jl_free(completed_jobs);
+}
+
+static int load_snapshot(const unsigned char* data, size_t size, NodeList** nodes, PriorityQueue** pq, HashTable** running_jobs, JobList** completed_jobs, JobPool* pool, int* current_time, int* next_job_id) {
+    SnapshotHeader header;
+    if (size < sizeof(header)) {
+        return 0;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.version < SNAPSHOT_MIN_VERSION || header.version > SNAPSHOT_VERSION || header.file_size != size ||
+        header.section_count > (size - sizeof(header)) / sizeof(SnapshotSection)) {
+        return 0; // Unsupported version or truncated file
+    }
+    if (fnv1a(FNV_OFFSET_BASIS, data + sizeof(header), size - sizeof(header)) != header.checksum) {
+        return 0; // Corrupt file
+    }
+    
+    const SnapshotSection* sections = (const SnapshotSection*)(data + sizeof(header));
+    const SnapshotSection* node_section = find_section(sections, header.section_count, SECTION_NODES, sizeof(NodeRecord), size);
+    const SnapshotSection* pending_section = find_section(sections, header.section_count, SECTION_PENDING, sizeof(JobRecord), size);
+    const SnapshotSection* running_section = find_section(sections, header.section_count, SECTION_RUNNING, sizeof(JobRecord), size);
+    const SnapshotSection* completed_section = find_section(sections, header.section_count, SECTION_COMPLETED, sizeof(JobRecord), size);
+    const SnapshotSection* stats_section = find_section(sections, header.section_count, SECTION_COMPLETED_STATS, sizeof(StatsRecord), size);
+    if (!node_section || !pending_section || !running_section || !completed_section || !stats_section) {
+        return 0;
+    }
+    
+    int node_count = (int)node_section->count;
+    int pending_count = (int)pending_section->count;
+    int running_count = (int)running_section->count;
+    int completed_count = (int)completed_section->count;
+    
+    // Size every structure up front
+    *nodes = nl_create(node_count);
+    *pq = pq_create(pending_count);
+    *running_jobs = ht_create(running_count + running_count / 4 + 16);
+    *completed_jobs = jl_create(pool);
+    Job** pending_jobs = (Job**)malloc((pending_count > 0 ? pending_count : 1) * sizeof(Job*));
+    if (!*nodes || !*pq || !*running_jobs || !*completed_jobs || !pending_jobs) {
+        free(pending_jobs);
+        return 0;
+    }
+    
+    *current_time = header.current_time;
+    *next_job_id = header.next_job_id;
+    
+    const unsigned char* records = data + node_section->offset;
+    for (int i = 0; i < node_count; i++) {
+        NodeRecord record;
+        memcpy(&record, records + (size_t)i * sizeof(record), sizeof(record));
+        ResourceNode* node = (ResourceNode*)malloc(sizeof(ResourceNode));
+        if (!node) {
+            free(pending_jobs);
+            return 0;
+        }
+        node->node_id = record.node_id;
+        node->total_cpu = record.total_cpu;
+        node->total_ram = record.total_ram;
+        node->available_cpu = record.available_cpu;
+        node->available_ram = record.available_ram;
+        if (!nl_add(*nodes, node)) {
+            free(node);
+            free(pending_jobs);
+            return 0;
+        }
+    }
+    
+    // Pending jobs are collected and heapified in one pass
+    records = data + pending_section->offset;
+    for (int i = 0; i < pending_count; i++) {
+        JobRecord record;
+        memcpy(&record, records + (size_t)i * sizeof(record), sizeof(record));
+        Job* job = jp_alloc(pool);
+        if (!job) {
+            free(pending_jobs);
+            return 0;
+        }
+        record_to_job(&record, job);
+        pending_jobs[i] = job;
+    }
+    int queued = pq_insert_batch(*pq, pending_jobs, pending_count);
+    free(pending_jobs);
+    if (!queued) {
+        return 0;
+    }
+    
+    records = data + running_section->offset;
+    for (int i = 0; i < running_count; i++) {
+        JobRecord record;
+        memcpy(&record, records + (size_t)i * sizeof(record), sizeof(record));
+        Job* job = jp_alloc(pool);
+        if (!job) {
+            return 0;
+        }
+        record_to_job(&record, job);
+        if (!ht_insert(*running_jobs, job, record.node_id)) {
+            return 0; // Its resources are already deducted from the node
+        }
+    }
+    
+    records = data + completed_section->offset;
+    for (int i = 0; i < completed_count; i++) {
+        JobRecord record;
+        memcpy(&record, records + (size_t)i * sizeof(record), sizeof(record));
+        Job* job = jp_alloc(pool);
+        if (!job) {
+            return 0;
+        }
+        record_to_job(&record, job);
+        if (!jl_add(*completed_jobs, job)) {
+            return 0;
+        }
+    }
+    
+    StatsRecord stats;
+    memcpy(&stats, data + stats_section->offset, sizeof(stats));
+    (*completed_jobs)->stats.completed = stats.completed;
+    (*completed_jobs)->stats.total_wait = stats.total_wait;
+    (*completed_jobs)->stats.total_turnaround = stats.total_turnaround;
+    (*completed_jobs)->stats.cpu_ticks = stats.cpu_ticks;
+    (*completed_jobs)->stats.ram_ticks = stats.ram_ticks;
+    
+    // Histograms saved with the snapshot replace the ones rebuilt from the
+    // retained jobs, which miss every evicted job
+    const SnapshotSection* latency_section = find_section(sections, header.section_count, SECTION_LATENCY, sizeof(HistogramRecord), size);
+    if (latency_section) {
+        memset((*completed_jobs)->latency, 0, sizeof(LatencyStats));
+        records = data + latency_section->offset;
+        for (uint64_t i = 0; i < latency_section->count; i++) {
+            HistogramRecord record;
+            memcpy(&record, records + i * sizeof(record), sizeof(record));
+            Histogram* h = latency_histogram((*completed_jobs)->latency, record.kind, record.latency_class);
+            if (!h) {
+                return 0; // Corrupt record
+            }
+            h->min = record.min;
+            h->max = record.max;
+            h->count = record.count;
+            h->sum = record.sum;
+            memcpy(h->buckets, record.buckets, sizeof(h->buckets));
+        }
+    }
+    
+    return 1; // Success
+}
 
 int save_state(const char* filename, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int current_time, int next_job_id) {
     if (!filename || !nodes || !pq || !running_jobs || !completed_jobs) {
@@ -27,81 +608,105 @@ int save_state(const char* filename, NodeList* nodes, PriorityQueue* pq, HashTab
                 node->available_cpu, node->available_ram);
     }
     
-    // Write pending jobs (from priority queue)
-    // We need to extract all jobs, save them, then re-insert them
-    PriorityQueue* temp_pq = pq_create(pq->capacity);
-    if (!temp_pq) {
-        fclose(file);
-        return 0;
-    }
-    
-    int pending_count = pq_size(pq);
-    Job** pending_jobs = (Job**)malloc(pending_count * sizeof(Job*));
-    if (!pending_jobs) {
-        pq_free(temp_pq);
-        fclose(file);
-        return 0;
-    }
-    
-    // Extract all jobs
-    for (int i = 0; i < pending_count; i++) {
-        pending_jobs[i] = pq_extract_min(pq);
-    }
-    
-    // Write pending jobs
-    fprintf(file, "PENDING_JOBS %d\n", pending_count);
-    for (int i = 0; i < pending_count; i++) {
-        Job* job = pending_jobs[i];
-        fprintf(file, "JOB %d %d %d %d %d %d %d\n",
+    // Write pending jobs in priority order, read straight from the heap
+    // without modifying the queue
+    fprintf(file, "PENDING_JOBS %d\n", pq_size(pq));
+    PQIterator it;
+    pq_iter_init(&it, pq);
+    Job* job;
+    while ((job = pq_iter_next(&it)) != NULL) {
+        fprintf(file, "JOB %d %d %d %d %d %d %d %d %d\n",
                 job->job_id, job->priority, job->required_cpu,
-                job->required_ram, job->duration, job->status, job->arrival_time);
+                job->required_ram, job->duration, job->status, job->arrival_time,
+                job->start_time, job->finish_time);
     }
-    
-    // Re-insert jobs back into priority queue
-    for (int i = 0; i < pending_count; i++) {
-        pq_insert(pq, pending_jobs[i]);
+    int iter_failed = it.failed;
+    pq_iter_free(&it);
+    if (iter_failed) {
+        fclose(file);
+        return 0; // Ran out of memory part-way through
     }
-    free(pending_jobs);
-    pq_free(temp_pq);
     
     // Write running jobs
     int running_count = ht_size(running_jobs);
     fprintf(file, "RUNNING_JOBS %d\n", running_count);
     
     // Traverse hash table to save running jobs
-    for (int i = 0; i < running_jobs->size; i++) {
-        HashNode* current = running_jobs->table[i];
-        while (current) {
-            fprintf(file, "RUNNING_JOB %d %d\n", current->job->job_id, current->node_id);
-            fprintf(file, "JOB %d %d %d %d %d %d %d\n",
-                    current->job->job_id, current->job->priority,
-                    current->job->required_cpu, current->job->required_ram,
-                    current->job->duration, current->job->status,
-                    current->job->arrival_time);
-            current = current->next;
+    for (int i = 0; i < running_jobs->capacity; i++) {
+        HashNode* current = &running_jobs->table[i];
+        if (!current->job) {
+            continue; // Empty slot
         }
-    }
-    
-    // Write completed jobs
-    fprintf(file, "COMPLETED_JOBS %d\n", jl_size(completed_jobs));
-    JobNode* current = completed_jobs->head;
-    while (current) {
-        fprintf(file, "JOB %d %d %d %d %d %d %d\n",
+        fprintf(file, "RUNNING_JOB %d %d\n", current->job->job_id, current->node_id);
+        fprintf(file, "JOB %d %d %d %d %d %d %d %d %d\n",
                 current->job->job_id, current->job->priority,
                 current->job->required_cpu, current->job->required_ram,
                 current->job->duration, current->job->status,
-                current->job->arrival_time);
-        current = current->next;
+                current->job->arrival_time, current->job->start_time,
+                current->job->finish_time);
+    }
+    
+    // Write completed jobs (only the retained window is kept in memory)
+    fprintf(file, "COMPLETED_JOBS %d\n", jl_size(completed_jobs));
+    for (int i = 0; i < jl_size(completed_jobs); i++) {
+        Job* job = jl_get(completed_jobs, i);
+        fprintf(file, "JOB %d %d %d %d %d %d %d %d %d\n",
+                job->job_id, job->priority, job->required_cpu,
+                job->required_ram, job->duration, job->status, job->arrival_time,
+                job->start_time, job->finish_time);
+    }
+    
+    // Aggregates over every completed job, including evicted ones
+    CompletionStats* stats = &completed_jobs->stats;
+    fprintf(file, "COMPLETED_STATS %lld %lld %lld %lld %lld\n",
+            stats->completed, stats->total_wait, stats->total_turnaround,
+            stats->cpu_ticks, stats->ram_ticks);
+    
+    // Latency histograms: a summary line, then one line per non-empty bucket
+    for (int kind = 0; kind < LATENCY_KINDS; kind++) {
+        for (int i = 0; i < LATENCY_CLASSES; i++) {
+            Histogram* h = latency_histogram(completed_jobs->latency, kind, i);
+            if (h->count == 0) {
+                continue;
+            }
+            fprintf(file, "LATENCY %s %d %lld %lld %d %d\n",
+                    LATENCY_KIND_NAMES[kind], i, h->count, h->sum, h->min, h->max);
+            for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                if (h->buckets[b] > 0) {
+                    fprintf(file, "LATENCY_BUCKET %s %d %d %lld\n",
+                            LATENCY_KIND_NAMES[kind], i, b, h->buckets[b]);
+                }
+            }
+        }
     }
     
     fclose(file);
     return 1; // Success
 }
 
-int load_state(const char* filename, NodeList** nodes, PriorityQueue** pq, HashTable** running_jobs, JobList** completed_jobs, int* current_time, int* next_job_id) {
-    if (!filename) {
+int load_state(const char* filename, NodeList** nodes, PriorityQueue** pq, HashTable** running_jobs, JobList** completed_jobs, JobPool* pool, int* current_time, int* next_job_id) {
+    if (!filename || !nodes || !pq || !running_jobs || !completed_jobs || !pool) {
         return 0; // Error
     }
+    *nodes = NULL;
+    *pq = NULL;
+    *running_jobs = NULL;
+    *completed_jobs = NULL;
+    
+    // Binary snapshots are recognized by their magic number
+    size_t size = 0;
+    const unsigned char* data = map_file(filename, &size);
+    if (data && size >= 8 && memcmp(data, SNAPSHOT_MAGIC, 8) == 0) {
+        int ok = load_snapshot(data, size, nodes, pq, running_jobs, completed_jobs, pool, current_time, next_job_id);
+        unmap_file(data, size);
+        if (!ok) {
+            goto fail;
+        }
+        return 1; // Success
+    }
+    if (data) {
+        unmap_file(data, size);
+    }
     
     FILE* file = fopen(filename, "r");
     if (!file) {
@@ -115,11 +720,11 @@ int load_state(const char* filename, NodeList** nodes, PriorityQueue** pq, HashT
     *nodes = nl_create(10);
     *pq = pq_create(10);
     *running_jobs = ht_create(16);
-    *completed_jobs = jl_create();
+    *completed_jobs = jl_create(pool);
     
     if (!*nodes || !*pq || !*running_jobs || !*completed_jobs) {
         fclose(file);
-        return 0;
+        goto fail;
     }
     
     int pending_count = 0;
@@ -128,8 +733,15 @@ int load_state(const char* filename, NodeList** nodes, PriorityQueue** pq, HashT
     int nodes_count = 0;
     int last_running_job_id = -1;
     int last_running_node_id = -1;
+    int has_stats = 0;
+    int has_latency = 0;
+    CompletionStats stats;
+    Job** pending_jobs = NULL;
+    int ok = 1;
+    int pending_loaded = 0;
+    int pending_capacity = 0;
     
-    while (fgets(line, sizeof(line), file)) {
+    while (ok && fgets(line, sizeof(line), file)) {
         line_num++;
         
         // Skip comments and empty lines
@@ -155,7 +767,10 @@ int load_state(const char* filename, NodeList** nodes, PriorityQueue** pq, HashT
                     node->total_ram = total_ram;
                     node->available_cpu = available_cpu;
                     node->available_ram = available_ram;
-                    nl_add(*nodes, node);
+                }
+                if (!node || !nl_add(*nodes, node)) {
+                    free(node);
+                    ok = 0;
                 }
             }
         } else if (strncmp(line, "PENDING_JOBS ", 13) == 0) {
@@ -164,16 +779,51 @@ int load_state(const char* filename, NodeList** nodes, PriorityQueue** pq, HashT
             sscanf(line, "RUNNING_JOBS %d", &running_count);
         } else if (strncmp(line, "COMPLETED_JOBS ", 15) == 0) {
             sscanf(line, "COMPLETED_JOBS %d", &completed_count);
+        } else if (strncmp(line, "COMPLETED_STATS ", 16) == 0) {
+            has_stats = sscanf(line, "COMPLETED_STATS %lld %lld %lld %lld %lld",
+                               &stats.completed, &stats.total_wait, &stats.total_turnaround,
+                               &stats.cpu_ticks, &stats.ram_ticks) == 5;
+        } else if (strncmp(line, "LATENCY", 7) == 0) {
+            // Written after every job, so the histograms rebuilt from the
+            // retained jobs are dropped once, at the first of these lines
+            if (!has_latency) {
+                memset((*completed_jobs)->latency, 0, sizeof(LatencyStats));
+                has_latency = 1;
+            }
+            char kind_name[16];
+            int latency_class, bucket, min, max;
+            long long count, sum;
+            Histogram* h = NULL;
+            if (sscanf(line, "LATENCY_BUCKET %15s %d %d %lld",
+                       kind_name, &latency_class, &bucket, &count) == 4) {
+                h = latency_histogram((*completed_jobs)->latency, latency_kind(kind_name), latency_class);
+                if (h && bucket >= 0 && bucket < HISTOGRAM_BUCKETS) {
+                    h->buckets[bucket] = count;
+                }
+            } else if (sscanf(line, "LATENCY %15s %d %lld %lld %d %d",
+                              kind_name, &latency_class, &count, &sum, &min, &max) == 6) {
+                h = latency_histogram((*completed_jobs)->latency, latency_kind(kind_name), latency_class);
+                if (h) {
+                    h->count = count;
+                    h->sum = sum;
+                    h->min = min;
+                    h->max = max;
+                }
+            }
         } else if (strncmp(line, "RUNNING_JOB ", 12) == 0) {
             // Store the job_id and node_id for the next JOB line
             sscanf(line, "RUNNING_JOB %d %d", &last_running_job_id, &last_running_node_id);
         } else if (strncmp(line, "JOB ", 4) == 0) {
             int job_id, priority, required_cpu, required_ram, duration, status, arrival_time;
-            if (sscanf(line, "JOB %d %d %d %d %d %d %d",
-                      &job_id, &priority, &required_cpu, &required_ram,
-                      &duration, &status, &arrival_time) == 7) {
-                Job* job = (Job*)malloc(sizeof(Job));
-                if (job) {
+            int start_time = -1, finish_time = -1;
+            int fields = sscanf(line, "JOB %d %d %d %d %d %d %d %d %d",
+                                &job_id, &priority, &required_cpu, &required_ram,
+                                &duration, &status, &arrival_time, &start_time, &finish_time);
+            if (fields == 7 || fields == 9) {
+                Job* job = jp_alloc(pool);
+                if (!job) {
+                    ok = 0;
+                } else {
                     job->job_id = job_id;
                     job->priority = priority;
                     job->required_cpu = required_cpu;
@@ -181,16 +831,40 @@ int load_state(const char* filename, NodeList** nodes, PriorityQueue** pq, HashT
                     job->duration = duration;
                     job->status = status;
                     job->arrival_time = arrival_time;
+                    job->start_time = start_time;
+                    job->finish_time = finish_time;
                     
                     // Check if this is a running job (preceded by RUNNING_JOB line)
                     if (job_id == last_running_job_id) {
                         job->status = 1; // Mark as running
-                        ht_insert(*running_jobs, job, last_running_node_id);
+                        if (fields == 7) {
+                            // Older files store the remaining duration only
+                            job->start_time = *current_time;
+                            job->finish_time = *current_time + duration;
+                        }
+                        if (!ht_insert(*running_jobs, job, last_running_node_id)) {
+                            ok = 0;
+                        }
                         last_running_job_id = -1; // Reset
                     } else if (status == 0) { // Pending
-                        pq_insert(*pq, job);
+                        // Collected and heapified in one pass at the end
+                        if (pending_loaded >= pending_capacity) {
+                            int new_capacity = pending_capacity * 2;
+                            if (new_capacity == 0) new_capacity = 64;
+                            Job** new_pending = (Job**)realloc(pending_jobs, new_capacity * sizeof(Job*));
+                            if (!new_pending) {
+                                jp_release(pool, job);
+                                ok = 0;
+                                continue;
+                            }
+                            pending_jobs = new_pending;
+                            pending_capacity = new_capacity;
+                        }
+                        pending_jobs[pending_loaded++] = job;
                     } else if (status == 2) { // Completed
-                        jl_add(*completed_jobs, job);
+                        if (!jl_add(*completed_jobs, job)) {
+                            ok = 0;
+                        }
                     }
                 }
             }
@@ -198,6 +872,27 @@ int load_state(const char* filename, NodeList** nodes, PriorityQueue** pq, HashT
     }
     
     fclose(file);
+    if (ok) {
+        ok = pq_insert_batch(*pq, pending_jobs, pending_loaded);
+    }
+    free(pending_jobs);
+    if (!ok) {
+        goto fail;
+    }
+    
+    // Restore aggregates that also cover jobs evicted before the save
+    if (has_stats) {
+        (*completed_jobs)->stats = stats;
+    }
     return 1; // Success
+    
+fail:
+    // Free whatever was built; jobs already taken from the pool stay there
+    free_loaded_state(*nodes, *pq, *running_jobs, *completed_jobs);
+    *nodes = NULL;
+    *pq = NULL;
+    *running_jobs = NULL;
+    *completed_jobs = NULL;
+    return 0;
 }
 
@@ -6,15 +6,27 @@
 #include "priority_queue.h"
 #include "hash_table.h"
 #include "job_list.h"
+#include "job_pool.h"
 
-// Save the current state to a file
+// Save the current state to a binary snapshot (versioned, checksummed,
+// fixed-size records in sections that can be loaded with mmap)
+// The snapshot is written to "<filename>.tmp", fsync'ed and renamed over
+// filename, so an existing snapshot is only ever replaced by a complete one
+// Returns 1 on success, 0 on failure
+int save_snapshot(const char* filename, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int current_time, int next_job_id);
+
+// Save the current state to a text file (export format)
 // Returns 1 on success, 0 on failure
 int save_state(const char* filename, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int current_time, int next_job_id);
 
-// Load the state from a file
+// Load the state from a file, either a binary snapshot or a text export
+// (detected from the file contents)
 // Returns 1 on success, 0 on failure
-// The loaded state will be stored in the provided pointers
-int load_state(const char* filename, NodeList** nodes, PriorityQueue** pq, HashTable** running_jobs, JobList** completed_jobs, int* current_time, int* next_job_id);
+// The loaded state will be stored in the provided pointers; jobs are
+// allocated from pool. On failure every structure built so far is freed and
+// the pointers are set to NULL, but jobs already taken from pool stay there
+// (clear the pool to drop them)
+int load_state(const char* filename, NodeList** nodes, PriorityQueue** pq, HashTable** running_jobs, JobList** completed_jobs, JobPool* pool, int* current_time, int* next_job_id);
 
 #endif // PERSISTENCE_H
 
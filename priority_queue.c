@@ -1,6 +1,115 @@
 #include "priority_queue.h"
+#include "hash_table.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+// Queue order: priority, then arrival time, then job id (FIFO among equals).
+// With aging, the key is priority * aging + arrival_time: waiting `aging`
+// ticks is worth one priority level. The key never changes while a job
+// waits, so the heap stays valid without touching queued jobs.
+static int job_before(PriorityQueue* pq, const Job* a, const Job* b) {
+    if (pq->aging > 0) {
+        long long key_a = (long long)a->priority * pq->aging + a->arrival_time;
+        long long key_b = (long long)b->priority * pq->aging + b->arrival_time;
+        if (key_a != key_b) return key_a < key_b;
+    }
+    if (a->priority != b->priority) return a->priority < b->priority;
+    if (a->arrival_time != b->arrival_time) return a->arrival_time < b->arrival_time;
+    return a->job_id < b->job_id;
+}
+
+// Index of the lowest set bit (word must be non-zero)
+static int lowest_bit(unsigned long long word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1ULL)) {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+// --- Pending-job index ---
+
+static int index_create(JobIndex* index, int capacity) {
+    int size = 16;
+    while (size < 2 * capacity) {
+        size *= 2;
+    }
+    index->slots = (Job**)calloc(size, sizeof(Job*));
+    index->capacity = size;
+    index->count = 0;
+    return index->slots != NULL;
+}
+
+// Slot holding job_id, or the empty slot where it would go
+static int index_slot(const JobIndex* index, int job_id) {
+    int mask = index->capacity - 1;
+    int slot = (int)hash(job_id, index->capacity);
+    while (index->slots[slot] && index->slots[slot]->job_id != job_id) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static int index_grow(JobIndex* index) {
+    JobIndex grown;
+    grown.capacity = index->capacity * 2;
+    grown.count = index->count;
+    grown.slots = (Job**)calloc(grown.capacity, sizeof(Job*));
+    if (!grown.slots) {
+        return 0; // Failed to resize
+    }
+    for (int i = 0; i < index->capacity; i++) {
+        if (index->slots[i]) {
+            grown.slots[index_slot(&grown, index->slots[i]->job_id)] = index->slots[i];
+        }
+    }
+    free(index->slots);
+    *index = grown;
+    return 1;
+}
+
+static int index_insert(JobIndex* index, Job* job) {
+    if (2 * (index->count + 1) > index->capacity && !index_grow(index)) {
+        return 0;
+    }
+    int slot = index_slot(index, job->job_id);
+    if (!index->slots[slot]) {
+        index->count++;
+    }
+    index->slots[slot] = job;
+    return 1;
+}
+
+static Job* index_find(const JobIndex* index, int job_id) {
+    return index->slots[index_slot(index, job_id)];
+}
+
+static void index_remove(JobIndex* index, int job_id) {
+    int mask = index->capacity - 1;
+    int slot = index_slot(index, job_id);
+    if (!index->slots[slot]) {
+        return; // Not indexed
+    }
+    
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole unless that would move them before their home slot
+    int hole = slot;
+    for (int next = (hole + 1) & mask; index->slots[next]; next = (next + 1) & mask) {
+        int home = (int)hash(index->slots[next]->job_id, index->capacity);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            index->slots[hole] = index->slots[next];
+            hole = next;
+        }
+    }
+    index->slots[hole] = NULL;
+    index->count--;
+}
 
 PriorityQueue* pq_create(int capacity) {
     if (capacity <= 0) {
@@ -13,13 +122,22 @@ PriorityQueue* pq_create(int capacity) {
     }
     
     pq->jobs = (Job**)malloc(capacity * sizeof(Job*));
-    if (!pq->jobs) {
+    if (!pq->jobs || !index_create(&pq->index, capacity)) {
+        free(pq->jobs);
         free(pq);
         return NULL;
     }
     
     pq->size = 0;
     pq->capacity = capacity;
+    pq->kind = PQ_KIND_HEAP;
+    pq->bucket_head = NULL;
+    pq->bucket_tail = NULL;
+    pq->level_bits = NULL;
+    pq->level_summary = 0;
+    pq->bucket_count = 0;
+    pq->aging = 0;
+    pq->version = 0;
     return pq;
 }
 
@@ -36,18 +154,26 @@ static int pq_resize(PriorityQueue* pq) {
     return 1;
 }
 
+// Put a job in a heap slot, keeping its position index in sync
+static void heap_set(PriorityQueue* pq, int index, Job* job) {
+    pq->jobs[index] = job;
+    job->queue_index = index;
+}
+
+static void heap_swap(PriorityQueue* pq, int i, int j) {
+    Job* temp = pq->jobs[i];
+    heap_set(pq, i, pq->jobs[j]);
+    heap_set(pq, j, temp);
+}
+
 void heapify_up(PriorityQueue* pq, int index) {
     if (index == 0) return;
     
     int parent = (index - 1) / 2;
     
-    // Min-heap: parent should have lower or equal priority value
-    if (pq->jobs[parent]->priority > pq->jobs[index]->priority) {
-        // Swap
-        Job* temp = pq->jobs[parent];
-        pq->jobs[parent] = pq->jobs[index];
-        pq->jobs[index] = temp;
-        
+    // Min-heap: parent should come first in queue order
+    if (job_before(pq, pq->jobs[index], pq->jobs[parent])) {
+        heap_swap(pq, parent, index);
         heapify_up(pq, parent);
     }
 }
@@ -57,27 +183,110 @@ void heapify_down(PriorityQueue* pq, int index) {
     int right = 2 * index + 2;
     int smallest = index;
     
-    // Find the smallest priority among node and its children
-    if (left < pq->size && pq->jobs[left]->priority < pq->jobs[smallest]->priority) {
+    // Find the first job in queue order among node and its children
+    if (left < pq->size && job_before(pq, pq->jobs[left], pq->jobs[smallest])) {
         smallest = left;
     }
-    if (right < pq->size && pq->jobs[right]->priority < pq->jobs[smallest]->priority) {
+    if (right < pq->size && job_before(pq, pq->jobs[right], pq->jobs[smallest])) {
         smallest = right;
     }
     
     // If smallest is not the current node, swap and continue
     if (smallest != index) {
-        Job* temp = pq->jobs[index];
-        pq->jobs[index] = pq->jobs[smallest];
-        pq->jobs[smallest] = temp;
-        
+        heap_swap(pq, index, smallest);
         heapify_down(pq, smallest);
     }
 }
 
-int pq_insert(PriorityQueue* pq, Job* job) {
-    if (!pq || !job) {
-        return 0; // Error
+// Remove the job in a heap slot: the last job takes its place and is sifted
+// whichever way restores the heap
+static Job* heap_remove_at(PriorityQueue* pq, int index) {
+    Job* job = pq->jobs[index];
+    pq->size--;
+    if (index < pq->size) {
+        Job* last = pq->jobs[pq->size];
+        heap_set(pq, index, last);
+        heapify_up(pq, index);
+        heapify_down(pq, last->queue_index);
+    }
+    job->queue_index = -1;
+    return job;
+}
+
+// Whether a job can be appended to its level's list. Each level is kept in
+// queue order by only ever appending at the tail, so a job that belongs
+// before the tail (an older job moved by pq_update_priority) goes to the
+// overflow heap instead of walking the list to its arrival slot
+static int bucket_accepts(PriorityQueue* pq, Job* job) {
+    // Aging orders by a composite key, so every job goes to the heap
+    if (pq->kind != PQ_KIND_BUCKET || pq->aging != 0 ||
+        job->priority < 0 || job->priority >= PQ_BUCKET_LEVELS) {
+        return 0;
+    }
+    Job* tail = pq->bucket_tail[job->priority];
+    return !tail || job_before(pq, tail, job);
+}
+
+// Append a job to its level's list (the caller checked bucket_accepts)
+static void bucket_push(PriorityQueue* pq, Job* job) {
+    int level = job->priority;
+    Job* prev = pq->bucket_tail[level];
+    job->queue_prev = prev;
+    job->queue_next = NULL;
+    if (prev) {
+        prev->queue_next = job;
+    } else {
+        pq->bucket_head[level] = job;
+    }
+    pq->bucket_tail[level] = job;
+    
+    pq->level_bits[level / 64] |= 1ULL << (level % 64);
+    pq->level_summary |= 1ULL << (level / 64);
+    job->queue_index = -1;
+    pq->bucket_count++;
+}
+
+// Lowest non-empty level, or -1 if every bucket is empty
+static int bucket_min_level(PriorityQueue* pq) {
+    if (pq->level_summary == 0) {
+        return -1;
+    }
+    int word = lowest_bit(pq->level_summary);
+    return word * 64 + lowest_bit(pq->level_bits[word]);
+}
+
+// Unlink a bucketed job from its level's list
+static Job* bucket_unlink(PriorityQueue* pq, Job* job) {
+    int level = job->priority;
+    if (job->queue_prev) {
+        job->queue_prev->queue_next = job->queue_next;
+    } else {
+        pq->bucket_head[level] = job->queue_next;
+    }
+    if (job->queue_next) {
+        job->queue_next->queue_prev = job->queue_prev;
+    } else {
+        pq->bucket_tail[level] = job->queue_prev;
+    }
+    
+    if (!pq->bucket_head[level]) {
+        pq->level_bits[level / 64] &= ~(1ULL << (level % 64));
+        if (pq->level_bits[level / 64] == 0) {
+            pq->level_summary &= ~(1ULL << (level / 64));
+        }
+    }
+    job->queue_next = NULL;
+    job->queue_prev = NULL;
+    pq->bucket_count--;
+    return job;
+}
+
+// Place an already indexed job in the bucket or heap part
+static int queue_place(PriorityQueue* pq, Job* job) {
+    pq->version++;
+    if (bucket_accepts(pq, job)) {
+        bucket_push(pq, job);
+        return 1;
     }
     
     // Resize if necessary
@@ -87,54 +296,428 @@ int pq_insert(PriorityQueue* pq, Job* job) {
         }
     }
     
-    // Add job at the end
-    pq->jobs[pq->size] = job;
+    // Add job at the end and heapify up to maintain min-heap property
+    heap_set(pq, pq->size, job);
     pq->size++;
-    
-    // Heapify up to maintain min-heap property
     heapify_up(pq, pq->size - 1);
+    return 1;
+}
+
+// Take a queued job out of the bucket or heap part (it stays indexed)
+static void queue_unplace(PriorityQueue* pq, Job* job) {
+    pq->version++;
+    if (job->queue_index >= 0) {
+        heap_remove_at(pq, job->queue_index);
+    } else {
+        bucket_unlink(pq, job);
+    }
+}
+
+int pq_insert(PriorityQueue* pq, Job* job) {
+    if (!pq || !job) {
+        return 0; // Error
+    }
     
+    if (!index_insert(&pq->index, job)) {
+        return 0; // Failed to index
+    }
+    if (!queue_place(pq, job)) {
+        index_remove(&pq->index, job->job_id);
+        return 0;
+    }
     return 1; // Success
 }
 
-Job* pq_extract_min(PriorityQueue* pq) {
-    if (!pq || pq->size == 0) {
-        return NULL;
+int pq_insert_batch(PriorityQueue* pq, Job** jobs, int count) {
+    if (!pq || (!jobs && count > 0) || count < 0) {
+        return 0; // Error
+    }
+    if (count == 0) {
+        return 1; // Nothing to insert
     }
     
-    // Root is the minimum
-    Job* min_job = pq->jobs[0];
+    // Buckets take each job in O(1); only out-of-range priorities reach the
+    // heap. A failure takes the jobs inserted so far back out, so the batch
+    // is all or nothing as with the heap
+    if (pq->kind == PQ_KIND_BUCKET) {
+        for (int i = 0; i < count; i++) {
+            if (!pq_insert(pq, jobs[i])) {
+                while (--i >= 0) {
+                    pq_remove(pq, jobs[i]);
+                }
+                return 0;
+            }
+        }
+        return 1; // Success
+    }
     
-    // Move last element to root
-    pq->jobs[0] = pq->jobs[pq->size - 1];
-    pq->size--;
+    // Index the whole batch first so a failure leaves the heap unchanged
+    for (int i = 0; i < count; i++) {
+        if (!index_insert(&pq->index, jobs[i])) {
+            while (--i >= 0) {
+                index_remove(&pq->index, jobs[i]->job_id);
+            }
+            return 0; // Failed to index
+        }
+    }
     
-    // Heapify down to maintain min-heap property
-    if (pq->size > 0) {
-        heapify_down(pq, 0);
+    // Grow once to fit the whole batch
+    if (pq->size + count > pq->capacity) {
+        int new_capacity = pq->capacity;
+        while (new_capacity < pq->size + count) {
+            new_capacity *= 2;
+        }
+        Job** new_jobs = (Job**)realloc(pq->jobs, new_capacity * sizeof(Job*));
+        if (!new_jobs) {
+            for (int i = 0; i < count; i++) {
+                index_remove(&pq->index, jobs[i]->job_id);
+            }
+            return 0; // Failed to resize
+        }
+        pq->jobs = new_jobs;
+        pq->capacity = new_capacity;
+    }
+    
+    pq->version++;
+    int old_size = pq->size;
+    for (int i = 0; i < count; i++) {
+        heap_set(pq, old_size + i, jobs[i]);
+    }
+    pq->size += count;
+    
+    // A small batch on a large heap is cheaper to sift up one by one
+    // (count * log n); otherwise restore the heap property bottom-up
+    // (Floyd's heap construction), which is O(n) for the whole array
+    int depth = 0;
+    while ((1 << depth) < pq->size) {
+        depth++;
+    }
+    if ((long long)count * depth < pq->size) {
+        for (int i = old_size; i < pq->size; i++) {
+            heapify_up(pq, i);
+        }
+    } else {
+        for (int i = pq->size / 2 - 1; i >= 0; i--) {
+            heapify_down(pq, i);
+        }
     }
     
+    return 1; // Success
+}
+
+Job* pq_extract_min(PriorityQueue* pq) {
+    Job* min_job = pq_peek(pq);
+    if (min_job) {
+        queue_unplace(pq, min_job);
+        index_remove(&pq->index, min_job->job_id);
+    }
     return min_job;
 }
 
+Job* pq_find(PriorityQueue* pq, int job_id) {
+    return pq ? index_find(&pq->index, job_id) : NULL;
+}
+
+int pq_remove(PriorityQueue* pq, Job* job) {
+    if (!pq || !job || pq_find(pq, job->job_id) != job) {
+        return 0; // Not queued
+    }
+    
+    queue_unplace(pq, job);
+    index_remove(&pq->index, job->job_id);
+    return 1;
+}
+
+int pq_update_priority(PriorityQueue* pq, Job* job, int priority) {
+    if (!pq || !job || pq_find(pq, job->job_id) != job) {
+        return 0; // Not queued
+    }
+    
+    // A heap job is re-keyed in place and sifted from its slot, unless the
+    // new priority lets it join the tail of a bucket
+    if (job->queue_index >= 0) {
+        int index = job->queue_index;
+        pq->version++;
+        job->priority = priority;
+        if (!bucket_accepts(pq, job)) {
+            heapify_up(pq, index);
+            heapify_down(pq, job->queue_index);
+        } else {
+            heap_remove_at(pq, index);
+            bucket_push(pq, job);
+        }
+        return 1;
+    }
+    
+    // A bucketed job moves to another level (or to the overflow heap)
+    bucket_unlink(pq, job);
+    job->priority = priority;
+    if (!queue_place(pq, job)) {
+        index_remove(&pq->index, job->job_id);
+        return 0; // Dropped: the heap could not grow
+    }
+    return 1;
+}
+
 Job* pq_peek(PriorityQueue* pq) {
-    if (!pq || pq->size == 0) {
+    if (!pq || pq_is_empty(pq)) {
         return NULL;
     }
+    
+    // The first bucketed job wins unless the heap holds an earlier one (a
+    // negative priority, or a reprioritized job older than its level's tail)
+    int level = bucket_min_level(pq);
+    if (level >= 0 && (pq->size == 0 || !job_before(pq, pq->jobs[0], pq->bucket_head[level]))) {
+        return pq->bucket_head[level];
+    }
     return pq->jobs[0];
 }
 
 int pq_is_empty(PriorityQueue* pq) {
-    return !pq || pq->size == 0;
+    return !pq || pq->size + pq->bucket_count == 0;
 }
 
 int pq_size(PriorityQueue* pq) {
-    return pq ? pq->size : 0;
+    return pq ? pq->size + pq->bucket_count : 0;
+}
+
+// Take every job out in the current order, apply a new kind or aging rate,
+// and put them back. Re-inserting in order keeps arrival order in the
+// buckets, and a sorted array is already a valid heap. Everything that can
+// fail is allocated before the first job moves, and the jobs stay indexed
+// throughout, so a failure leaves the queue exactly as it was
+static int pq_rebuild(PriorityQueue* pq, QueueKind kind, int aging) {
+    int count = pq_size(pq);
+    Job** ordered = (Job**)malloc((count > 0 ? count : 1) * sizeof(Job*));
+    if (!ordered) {
+        return 0;
+    }
+    
+    // Room for every job in the heap part, whichever part they end up in
+    if (pq->capacity < count) {
+        Job** new_jobs = (Job**)realloc(pq->jobs, count * sizeof(Job*));
+        if (!new_jobs) {
+            free(ordered);
+            return 0;
+        }
+        pq->jobs = new_jobs;
+        pq->capacity = count;
+    }
+    
+    if (kind == PQ_KIND_BUCKET && !pq->bucket_head) {
+        pq->bucket_head = (Job**)calloc(PQ_BUCKET_LEVELS, sizeof(Job*));
+        pq->bucket_tail = (Job**)calloc(PQ_BUCKET_LEVELS, sizeof(Job*));
+        pq->level_bits = (unsigned long long*)calloc(PQ_BUCKET_WORDS, sizeof(unsigned long long));
+        if (!pq->bucket_head || !pq->bucket_tail || !pq->level_bits) {
+            free(pq->bucket_head);
+            free(pq->bucket_tail);
+            free(pq->level_bits);
+            pq->bucket_head = NULL;
+            pq->bucket_tail = NULL;
+            pq->level_bits = NULL;
+            free(ordered);
+            return 0;
+        }
+    }
+    
+    for (int i = 0; i < count; i++) {
+        ordered[i] = pq_peek(pq);
+        queue_unplace(pq, ordered[i]);
+    }
+    
+    // Cannot fail: the heap already has room for every job
+    pq->kind = kind;
+    pq->aging = aging;
+    for (int i = 0; i < count; i++) {
+        queue_place(pq, ordered[i]);
+    }
+    free(ordered);
+    return 1;
+}
+
+int pq_set_kind(PriorityQueue* pq, QueueKind kind) {
+    if (!pq) {
+        return 0; // Error
+    }
+    if (pq->kind == kind) {
+        return 1; // Nothing to do
+    }
+    return pq_rebuild(pq, kind, pq->aging);
+}
+
+int pq_set_aging(PriorityQueue* pq, int aging) {
+    if (!pq || aging < 0) {
+        return 0; // Error
+    }
+    if (pq->aging == aging) {
+        return 1; // Nothing to do
+    }
+    
+    // The new key reorders the queue: one O(n) rebuild, never per tick
+    return pq_rebuild(pq, pq->kind, aging);
+}
+
+QueueKind pq_kind(PriorityQueue* pq) {
+    return pq ? pq->kind : PQ_KIND_HEAP;
+}
+
+const char* pq_kind_name(QueueKind kind) {
+    switch (kind) {
+        case PQ_KIND_BUCKET: return "bucket";
+        case PQ_KIND_HEAP:
+        default:             return "heap";
+    }
+}
+
+int pq_parse_kind(const char* name, QueueKind* kind) {
+    if (!name || !kind) {
+        return 0;
+    }
+    if (strcmp(name, "heap") == 0) {
+        *kind = PQ_KIND_HEAP;
+    } else if (strcmp(name, "bucket") == 0) {
+        *kind = PQ_KIND_BUCKET;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// Frontier of the ordered iterator: a small min-heap of heap-array indices
+static int iter_before(PQIterator* it, int a, int b) {
+    return job_before(it->pq, it->pq->jobs[a], it->pq->jobs[b]);
+}
+
+static int iter_push(PQIterator* it, int index) {
+    if (it->count >= it->capacity) {
+        int new_capacity = it->capacity * 2;
+        if (new_capacity == 0) new_capacity = 16;
+        int* new_frontier = (int*)realloc(it->frontier, new_capacity * sizeof(int));
+        if (!new_frontier) {
+            return 0; // Failed to resize
+        }
+        it->frontier = new_frontier;
+        it->capacity = new_capacity;
+    }
+    
+    int pos = it->count++;
+    it->frontier[pos] = index;
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!iter_before(it, it->frontier[pos], it->frontier[parent])) {
+            break;
+        }
+        int temp = it->frontier[pos];
+        it->frontier[pos] = it->frontier[parent];
+        it->frontier[parent] = temp;
+        pos = parent;
+    }
+    return 1;
+}
+
+static int iter_pop(PQIterator* it) {
+    int top = it->frontier[0];
+    it->frontier[0] = it->frontier[--it->count];
+    
+    int pos = 0;
+    while (1) {
+        int left = 2 * pos + 1;
+        int right = 2 * pos + 2;
+        int smallest = pos;
+        if (left < it->count && iter_before(it, it->frontier[left], it->frontier[smallest])) {
+            smallest = left;
+        }
+        if (right < it->count && iter_before(it, it->frontier[right], it->frontier[smallest])) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            break;
+        }
+        int temp = it->frontier[pos];
+        it->frontier[pos] = it->frontier[smallest];
+        it->frontier[smallest] = temp;
+        pos = smallest;
+    }
+    return top;
+}
+
+void pq_iter_init(PQIterator* it, PriorityQueue* pq) {
+    it->pq = pq;
+    it->frontier = NULL;
+    it->count = 0;
+    it->capacity = 0;
+    it->failed = 0;
+    it->bucket_next = NULL;
+    it->level = -1;
+    if (pq && pq->size > 0) {
+        it->failed = !iter_push(it, 0);
+    }
+    if (pq && pq->bucket_count > 0) {
+        it->level = bucket_min_level(pq);
+        it->bucket_next = pq->bucket_head[it->level];
+    }
+}
+
+// Move the bucket cursor to the head of the next non-empty level
+static void iter_next_level(PQIterator* it) {
+    PriorityQueue* pq = it->pq;
+    int level = it->level + 1;
+    it->bucket_next = NULL;
+    while (level < PQ_BUCKET_LEVELS) {
+        int word = level / 64;
+        unsigned long long bits = pq->level_bits[word] & (~0ULL << (level % 64));
+        if (bits) {
+            it->level = word * 64 + lowest_bit(bits);
+            it->bucket_next = pq->bucket_head[it->level];
+            return;
+        }
+        level = (word + 1) * 64;
+    }
+    it->level = PQ_BUCKET_LEVELS;
+}
+
+Job* pq_iter_next(PQIterator* it) {
+    if (!it || (it->count == 0 && !it->bucket_next)) {
+        return NULL;
+    }
+    
+    // Buckets are walked level by level in list order; the heap part is
+    // merged in wherever it comes first
+    if (it->bucket_next && (it->count == 0 || !job_before(it->pq, it->pq->jobs[it->frontier[0]], it->bucket_next))) {
+        Job* job = it->bucket_next;
+        it->bucket_next = job->queue_next;
+        if (!it->bucket_next) {
+            iter_next_level(it);
+        }
+        return job;
+    }
+    
+    // The next job in order is the smallest frontier entry; its children in
+    // the heap become candidates. The queue itself is never modified.
+    int index = iter_pop(it);
+    int left = 2 * index + 1;
+    int right = 2 * index + 2;
+    if (left < it->pq->size && !iter_push(it, left)) it->failed = 1;
+    if (right < it->pq->size && !iter_push(it, right)) it->failed = 1;
+    return it->pq->jobs[index];
+}
+
+void pq_iter_free(PQIterator* it) {
+    if (it) {
+        free(it->frontier);
+        it->frontier = NULL;
+        it->count = 0;
+        it->capacity = 0;
+    }
 }
 
 void pq_free(PriorityQueue* pq) {
     if (pq) {
         free(pq->jobs);
+        free(pq->bucket_head);
+        free(pq->bucket_tail);
+        free(pq->level_bits);
+        free(pq->index.slots);
         free(pq);
     }
 }
@@ -3,15 +3,44 @@
 
 #include "structs.h"
 
-// Create a new priority queue with initial capacity
+// Non-destructive iterator over pending jobs in priority order
+// Visiting k jobs costs O(k log k) and never modifies the queue; the queue
+// must not be modified while iterating
+typedef struct {
+    PriorityQueue* pq;
+    int* frontier;      // Min-heap of heap-array indices still to visit
+    int count;
+    int capacity;
+    int failed;         // Set if the frontier could not grow (jobs were skipped)
+    Job* bucket_next;   // Next bucketed job to visit (bucket kind)
+    int level;          // Level of bucket_next
+} PQIterator;
+
+// Create a new priority queue (heap kind) with initial capacity
 PriorityQueue* pq_create(int capacity);
 
 // Insert a job into the priority queue
 int pq_insert(PriorityQueue* pq, Job* job);
 
+// Insert many jobs at once: appends them and either sifts each one up
+// (small batches) or rebuilds the heap bottom-up in O(size + count)
+// All or nothing: on failure (returns 0) no job of the batch is queued
+int pq_insert_batch(PriorityQueue* pq, Job** jobs, int count);
+
 // Extract and return the job with minimum priority (highest priority)
 Job* pq_extract_min(PriorityQueue* pq);
 
+// Find a pending job by id in O(1), or NULL if it is not queued
+Job* pq_find(PriorityQueue* pq, int job_id);
+
+// Remove a queued job in O(log n) (O(1) for a bucketed job); returns 1 if
+// the job was queued
+int pq_remove(PriorityQueue* pq, Job* job);
+
+// Change a queued job's priority and restore the queue order in O(log n);
+// returns 1 on success
+int pq_update_priority(PriorityQueue* pq, Job* job, int priority);
+
 // Peek at the minimum priority job without removing it
 Job* pq_peek(PriorityQueue* pq);
 
@@ -21,9 +50,35 @@ int pq_is_empty(PriorityQueue* pq);
 // Get the size of the priority queue
 int pq_size(PriorityQueue* pq);
 
+// Switch between the heap and bucket implementations, keeping every job
+// and its order
+int pq_set_kind(PriorityQueue* pq, QueueKind kind);
+
+// Age waiting jobs: each `aging` ticks since arrival count as one priority
+// level (0 = off). Rebuilds the queue once; ticks do no extra work
+int pq_set_aging(PriorityQueue* pq, int aging);
+
+// Current implementation
+QueueKind pq_kind(PriorityQueue* pq);
+
+// Name of an implementation ("heap" or "bucket")
+const char* pq_kind_name(QueueKind kind);
+
+// Parse an implementation name; returns 1 on success
+int pq_parse_kind(const char* name, QueueKind* kind);
+
 // Free the priority queue (does not free jobs themselves)
 void pq_free(PriorityQueue* pq);
 
+// Start iterating over the queue in priority order
+void pq_iter_init(PQIterator* it, PriorityQueue* pq);
+
+// Next job in priority order, or NULL when done
+Job* pq_iter_next(PQIterator* it);
+
+// Release the iterator's memory
+void pq_iter_free(PQIterator* it);
+
 // Helper functions for heap operations
 void heapify_up(PriorityQueue* pq, int index);
 void heapify_down(PriorityQueue* pq, int index);
@@ -0,0 +1,347 @@
+#include "replay.h"
+#include "scheduler.h"
+#include "histogram.h"
+#include "metrics.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+// Jobs queued with one batched insert
+#define REPLAY_BATCH 1024
+
+// Fields per SWF line
+#define SWF_FIELDS 18
+
+typedef enum {
+    REPLAY_FORMAT_UNKNOWN,
+    REPLAY_FORMAT_SWF,
+    REPLAY_FORMAT_CSV
+} ReplayFormat;
+
+// One job read from a trace
+typedef struct {
+    long long submit;
+    int priority;
+    int cpu;
+    int ram;
+    int duration;
+} TraceJob;
+
+static int is_separator(char c) {
+    return c == ' ' || c == '\t' || c == ',';
+}
+
+// Split a line into integers separated by whitespace or commas (fractional
+// parts, which SWF allows in some fields, are dropped)
+// Returns the number of fields read (at most max), or -1 if a field is not
+// a number
+static int parse_fields(const char* p, long long* fields, int max) {
+    int count = 0;
+    while (count < max) {
+        while (is_separator(*p)) {
+            p++;
+        }
+        if (*p == '\0' || *p == '\n' || *p == '\r') {
+            break;
+        }
+        
+        char* end;
+        long long value = strtoll(p, &end, 10);
+        if (end == p) {
+            return -1;
+        }
+        p = end;
+        if (*p == '.') {
+            do {
+                p++;
+            } while (*p >= '0' && *p <= '9');
+        }
+        if (*p != '\0' && *p != '\n' && *p != '\r' && !is_separator(*p)) {
+            return -1;
+        }
+        fields[count++] = value;
+    }
+    return count;
+}
+
+// SWF fields (1-based in the format description): 2 submit time, 4 run time,
+// 5 allocated processors, 7 used memory, 8 requested processors, 10
+// requested memory, 15 queue number; -1 means not given
+// Returns 1 if the line describes a job that ran, 0 otherwise
+static int swf_job(const long long* fields, int count, TraceJob* job) {
+    if (count < 10) {
+        return 0;
+    }
+    
+    long long run_time = fields[3];
+    long long processors = fields[7] > 0 ? fields[7] : fields[4];
+    long long memory = fields[9] > 0 ? fields[9] : fields[6]; // KB per processor
+    if (fields[1] < 0 || run_time <= 0 || run_time > INT_MAX ||
+        processors <= 0 || processors > INT_MAX) {
+        return 0;
+    }
+    
+    long long ram = memory > 0 ? (memory * processors + 1023) / 1024 : 1;
+    job->submit = fields[1];
+    job->priority = count >= 15 && fields[14] > 0 && fields[14] <= INT_MAX ? (int)fields[14] : 0;
+    job->cpu = (int)processors;
+    job->ram = ram > INT_MAX ? INT_MAX : (int)ram;
+    job->duration = (int)run_time;
+    return 1;
+}
+
+// CSV: submit time, priority, cpu, ram, duration
+static int csv_job(const long long* fields, int count, TraceJob* job) {
+    if (count != 5 || fields[0] < 0 || fields[1] < 0 || fields[1] > INT_MAX ||
+        fields[2] <= 0 || fields[2] > INT_MAX || fields[3] <= 0 || fields[3] > INT_MAX ||
+        fields[4] <= 0 || fields[4] > INT_MAX) {
+        return 0;
+    }
+    
+    job->submit = fields[0];
+    job->priority = (int)fields[1];
+    job->cpu = (int)fields[2];
+    job->ram = (int)fields[3];
+    job->duration = (int)fields[4];
+    return 1;
+}
+
+// Pass the add-job command that reproduces each queued job to the record
+// callback
+static void record_jobs(Job** batch, int count, replay_record_callback record, void* user_data) {
+    if (!record) {
+        return;
+    }
+    
+    char command[128];
+    for (int i = 0; i < count; i++) {
+        snprintf(command, sizeof(command), "add-job %d %d %d %d", batch[i]->priority,
+                 batch[i]->required_cpu, batch[i]->required_ram, batch[i]->duration);
+        record(command, user_data);
+    }
+}
+
+// Queue a batch of jobs that arrived at the current time. If memory runs
+// out the jobs that made it into the queue stay there and the rest are
+// released, handing their IDs back (they were the last ones taken)
+static int queue_batch(Scheduler* sched, PriorityQueue* pq, JobPool* pool, Job** batch, int count, int* next_job_id,
+                       replay_record_callback record, void* user_data, ReplayReport* report) {
+    int queued = count;
+    if (!pq_insert_batch(pq, batch, count)) {
+        for (int i = 0; i < count; i++) {
+            if (!pq_find(pq, batch[i]->job_id) && !pq_insert(pq, batch[i])) {
+                queued = i;
+                break;
+            }
+        }
+    }
+    
+    for (int i = 0; i < queued; i++) {
+        TRACE_JOB(sched, TRACE_SUBMIT, batch[i], -1, batch[i]->arrival_time);
+    }
+    record_jobs(batch, queued, record, user_data);
+    report->jobs_submitted += queued;
+    if (queued < count) {
+        for (int i = queued; i < count; i++) {
+            jp_release(pool, batch[i]);
+        }
+        *next_job_id -= count - queued;
+        return 0; // Out of memory
+    }
+    return 1;
+}
+
+// Run the cluster to end_time (INT_MAX = until idle), recording the
+// equivalent run-ticks or run-until-idle command
+static void advance(Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs,
+                    JobList* completed_jobs, int* current_time, int end_time,
+                    replay_record_callback record, void* user_data, ReplayReport* report) {
+    int until_idle = end_time == INT_MAX;
+    if (record) {
+        char command[64];
+        if (until_idle) {
+            snprintf(command, sizeof(command), "run-until-idle");
+        } else {
+            snprintf(command, sizeof(command), "run-ticks %d", end_time - *current_time);
+        }
+        record(command, user_data);
+    }
+    report->passes += run_scheduler_until(sched, nodes, pq, running_jobs, completed_jobs,
+                                          current_time, end_time, until_idle);
+}
+
+int replay_trace(const char* path, Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs,
+                 JobList* completed_jobs, JobPool* pool, int* current_time, int* next_job_id,
+                 replay_record_callback record, void* user_data, ReplayReport* report) {
+    if (!path || !sched || !nodes || !pq || !running_jobs || !completed_jobs || !pool ||
+        !current_time || !next_job_id || !report) {
+        return 0;
+    }
+    
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return 0;
+    }
+    
+    // Completions before the replay are subtracted from the totals at the end
+    memset(report, 0, sizeof(*report));
+    Histogram wait_before = completed_jobs->latency->wait[LATENCY_ALL];
+    CompletionStats stats_before = completed_jobs->stats;
+    long long start_ns = metrics_now_ns();
+    
+    Job* batch[REPLAY_BATCH];
+    int count = 0;
+    int ok = 1;
+    int line_number = 0;
+    int seen_data = 0;
+    long long first_submit = -1;
+    ReplayFormat format = REPLAY_FORMAT_UNKNOWN;
+    char line[1024];
+    report->start_time = *current_time;
+    
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_number++;
+        const char* p = line;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == ';' || *p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue; // Comment or blank line
+        }
+        if (format == REPLAY_FORMAT_UNKNOWN) {
+            format = strchr(p, ',') ? REPLAY_FORMAT_CSV : REPLAY_FORMAT_SWF;
+        }
+        
+        long long fields[SWF_FIELDS];
+        int field_count = parse_fields(p, fields, SWF_FIELDS);
+        if (field_count < 0 && format == REPLAY_FORMAT_CSV && !seen_data) {
+            continue; // Header line
+        }
+        seen_data = 1;
+        
+        TraceJob trace_job;
+        int valid = field_count >= 0 &&
+                    (format == REPLAY_FORMAT_SWF ? swf_job(fields, field_count, &trace_job)
+                                                 : csv_job(fields, field_count, &trace_job));
+        if (!valid) {
+            if (field_count < 0 || (format == REPLAY_FORMAT_SWF && field_count < 10) ||
+                (format == REPLAY_FORMAT_CSV && field_count != 5)) {
+                if (report->first_bad_line == 0) {
+                    report->first_bad_line = line_number;
+                }
+            }
+            report->jobs_skipped++;
+            continue;
+        }
+        if (trace_job.cpu > nodes->max_total_cpu || trace_job.ram > nodes->max_total_ram) {
+            report->jobs_too_large++;
+            continue;
+        }
+        
+        // Arrival relative to the first job; a job listed out of order
+        // arrives as soon as it is read
+        if (first_submit < 0) {
+            first_submit = trace_job.submit;
+        }
+        long long arrival = report->start_time + (trace_job.submit - first_submit);
+        if (arrival >= INT_MAX) {
+            report->jobs_skipped++;
+            continue;
+        }
+        
+        // Run the cluster up to the arrival, one event at a time
+        if (arrival > *current_time) {
+            if (count > 0) {
+                ok = queue_batch(sched, pq, pool, batch, count, next_job_id, record, user_data, report);
+                count = 0;
+                if (!ok) {
+                    break;
+                }
+            }
+            advance(sched, nodes, pq, running_jobs, completed_jobs, current_time, (int)arrival,
+                    record, user_data, report);
+        }
+        
+        Job* job = jp_alloc(pool);
+        if (!job) {
+            ok = 0;
+            break;
+        }
+        job->job_id = (*next_job_id)++;
+        job->priority = trace_job.priority;
+        job->required_cpu = trace_job.cpu;
+        job->required_ram = trace_job.ram;
+        job->duration = trace_job.duration;
+        job->status = 0; // Pending
+        job->arrival_time = *current_time;
+        job->start_time = -1;
+        job->finish_time = -1;
+        batch[count++] = job;
+        if (count == REPLAY_BATCH) {
+            ok = queue_batch(sched, pq, pool, batch, count, next_job_id, record, user_data, report);
+            count = 0;
+        }
+    }
+    fclose(file);
+    
+    if (ok && count > 0) {
+        ok = queue_batch(sched, pq, pool, batch, count, next_job_id, record, user_data, report);
+    } else if (!ok) {
+        for (int i = 0; i < count; i++) {
+            jp_release(pool, batch[i]);
+        }
+        *next_job_id -= count;
+    }
+    if (!ok) {
+        return 0;
+    }
+    
+    // Run until every job that can start has finished
+    advance(sched, nodes, pq, running_jobs, completed_jobs, current_time, INT_MAX,
+            record, user_data, report);
+    
+    report->end_time = *current_time;
+    report->jobs_unfinished = pq_size(pq);
+    report->wait = completed_jobs->latency->wait[LATENCY_ALL];
+    hist_subtract(&report->wait, &wait_before);
+    
+    long long total_cpu = 0, total_ram = 0;
+    for (int i = 0; i < nodes->size; i++) {
+        total_cpu += nodes->nodes[i]->total_cpu;
+        total_ram += nodes->nodes[i]->total_ram;
+    }
+    long long makespan = report->end_time - report->start_time;
+    if (makespan > 0 && total_cpu > 0 && total_ram > 0) {
+        report->cpu_utilization = (double)(completed_jobs->stats.cpu_ticks - stats_before.cpu_ticks) /
+                                  ((double)total_cpu * makespan);
+        report->ram_utilization = (double)(completed_jobs->stats.ram_ticks - stats_before.ram_ticks) /
+                                  ((double)total_ram * makespan);
+    }
+    report->elapsed_seconds = (metrics_now_ns() - start_ns) / 1e9;
+    return 1;
+}
+
+void replay_print(const char* path, const ReplayReport* report) {
+    printf("\n=== Replay of %s ===\n\n", path);
+    printf("Jobs: %lld submitted, %lld skipped, %lld larger than any node\n",
+           report->jobs_submitted, report->jobs_skipped, report->jobs_too_large);
+    if (report->first_bad_line > 0) {
+        printf("  First malformed line: %d\n", report->first_bad_line);
+    }
+    if (report->jobs_unfinished > 0) {
+        printf("  Still queued: %d (no single node can fit them)\n", report->jobs_unfinished);
+    }
+    printf("Simulated time: %d to %d (makespan %d ticks)\n",
+           report->start_time, report->end_time, report->end_time - report->start_time);
+    printf("Utilization: CPU %.1f%%, RAM %.1f%%\n",
+           report->cpu_utilization * 100.0, report->ram_utilization * 100.0);
+    printf("Wait (ticks): mean %.2f, p50 %d, p99 %d, p99.9 %d, max %d\n",
+           hist_mean(&report->wait), hist_percentile(&report->wait, 0.5),
+           hist_percentile(&report->wait, 0.99), hist_percentile(&report->wait, 0.999),
+           report->wait.max);
+    printf("Replayed in %.3f s (%d scheduler ticks, %.0f jobs/s)\n\n",
+           report->elapsed_seconds, report->passes,
+           report->elapsed_seconds > 0 ? report->jobs_submitted / report->elapsed_seconds : 0.0);
+}
@@ -0,0 +1,56 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "structs.h"
+#include "scheduler.h"
+
+// Workload trace replay. A trace is streamed one line at a time and each
+// job is queued at its recorded submit time (offset so the first job
+// arrives at the current time), with simulated time advanced from one
+// arrival or completion to the next. Two formats are read:
+//   SWF (Parallel Workloads Archive Standard Workload Format): 18
+//   whitespace-separated fields per job, ';' comments. One tick is one
+//   second; CPU is the requested processors (allocated if not given), RAM
+//   is the requested memory per processor (used if not given) times the
+//   processors in MB, at least 1, and the priority is the queue number
+//   (0 if not given). Jobs without a positive run time were cancelled
+//   before running and are skipped
+//   CSV: "<submit_time>,<priority>,<cpu>,<ram>,<duration>" per line; a
+//   header line and '#' comments are skipped
+// Only the queue, the running jobs and the completed-job history window
+// are held in memory, however long the trace
+
+typedef struct {
+    long long jobs_submitted;
+    long long jobs_skipped;     // Malformed lines and jobs with no run time or resources
+    long long jobs_too_large;   // Larger than any node
+    int jobs_unfinished;        // Still queued when the replay ended (no node could fit them)
+    int first_bad_line;         // Line number of the first malformed line (0 = none)
+    int start_time;             // Arrival of the first job
+    int end_time;               // Last completion
+    int passes;                 // Scheduler ticks run
+    double cpu_utilization;     // Busy fraction of all CPU from start_time to end_time
+    double ram_utilization;
+    double elapsed_seconds;     // Wall-clock time of the replay
+    Histogram wait;             // Waits of the jobs completed during the replay
+} ReplayReport;
+
+// Called with each command that reproduces a step of the replay: an add-job
+// for every queued job and a run-ticks or run-until-idle for every advance
+// of simulated time
+typedef void (*replay_record_callback)(const char* command, void* user_data);
+
+// Replay a trace against the current nodes and queue, running until every
+// job that can start has completed. Jobs are allocated from pool and
+// numbered from *next_job_id; *current_time ends at the last completion.
+// Each step is passed to record (if not NULL) as it is taken, so a replay
+// that fails part way has recorded exactly the steps it applied
+// Returns 1 on success, 0 if the file cannot be read or memory runs out
+int replay_trace(const char* path, Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs,
+                 JobList* completed_jobs, JobPool* pool, int* current_time, int* next_job_id,
+                 replay_record_callback record, void* user_data, ReplayReport* report);
+
+// Print a replay report
+void replay_print(const char* path, const ReplayReport* report);
+
+#endif // REPLAY_H
@@ -1,102 +1,447 @@
 #include "scheduler.h"
+#include "metrics.h"
+#include "trace.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-// Structure to pass to hash table traversal callback
-typedef struct {
-    NodeList* nodes;
-    HashTable* running_jobs;
-    JobList* completed_jobs;
-    int* completed_job_ids;
-    int* completed_node_ids;
-    int completed_count;
-    int completed_capacity;
-} UpdateContext;
-
-// Callback function for updating running jobs
-static void update_running_job(Job* job, int node_id, void* user_data) {
-    UpdateContext* ctx = (UpdateContext*)user_data;
-    
-    if (!job || job->status != 1) { // Not running
-        return;
+// Submissions drained from the ring per pq_insert_batch call
+#define SUBMIT_BATCH 256
+
+Scheduler* scheduler_create(void) {
+    Scheduler* sched = (Scheduler*)calloc(1, sizeof(Scheduler));
+    if (!sched) {
+        return NULL;
+    }
+    sched->backfill_depth = DEFAULT_BACKFILL_DEPTH;
+    return sched;
+}
+
+void scheduler_free(Scheduler* sched) {
+    if (sched) {
+        free(sched->freed_cpu);
+        free(sched->freed_ram);
+        free(sched->freed_nodes);
+        free(sched->releases);
+        wp_free(sched->workers);
+        trace_stop(&sched->trace);
+        free(sched);
+    }
+}
+
+// Make the reservation scratch cover node_count nodes; new entries are zero
+static int reserve_buffers(Scheduler* sched, int node_count) {
+    if (node_count <= sched->freed_capacity) {
+        return 1;
+    }
+    int* freed_cpu = (int*)realloc(sched->freed_cpu, node_count * sizeof(int));
+    if (!freed_cpu) {
+        return 0;
+    }
+    sched->freed_cpu = freed_cpu;
+    int* freed_ram = (int*)realloc(sched->freed_ram, node_count * sizeof(int));
+    if (!freed_ram) {
+        return 0;
+    }
+    sched->freed_ram = freed_ram;
+    int* freed_nodes = (int*)realloc(sched->freed_nodes, node_count * sizeof(int));
+    if (!freed_nodes) {
+        return 0;
     }
+    sched->freed_nodes = freed_nodes;
     
-    // Decrement duration
-    job->duration--;
+    int old_capacity = sched->freed_capacity;
+    memset(freed_cpu + old_capacity, 0, (node_count - old_capacity) * sizeof(int));
+    memset(freed_ram + old_capacity, 0, (node_count - old_capacity) * sizeof(int));
+    sched->freed_capacity = node_count;
+    return 1;
+}
+
+void scheduler_invalidate(Scheduler* sched) {
+    sched->placement_valid = 0;
+}
+
+void scheduler_pass_counts(const Scheduler* sched, long long* run, long long* skipped) {
+    if (run) *run = sched->passes_run;
+    if (skipped) *skipped = sched->passes_skipped;
+}
+
+int scheduler_set_threads(Scheduler* sched, int threads) {
+    if (threads > HT_EVENT_SHARDS) {
+        threads = HT_EVENT_SHARDS; // More would have no shard to collect
+    }
+    WorkerPool* workers = NULL;
+    if (threads > 1) {
+        workers = wp_create(threads);
+        if (!workers) {
+            return 0;
+        }
+    }
+    wp_free(sched->workers);
+    sched->workers = workers;
+    return 1;
+}
+
+int scheduler_threads(const Scheduler* sched) {
+    return wp_threads(sched->workers);
+}
+
+void scheduler_set_backfill_depth(Scheduler* sched, int depth) {
+    sched->backfill_depth = depth > 0 ? depth : 0;
+    scheduler_invalidate(sched);
+}
+
+int scheduler_backfill_depth(const Scheduler* sched) {
+    return sched->backfill_depth;
+}
+
+long long scheduler_out_of_order_starts(const Scheduler* sched) {
+    return sched->out_of_order_starts;
+}
+
+void scheduler_attach_submit_queue(Scheduler* sched, SubmitQueue* sq, JobPool* pool, int* next_job_id) {
+    if (!sq || !pool || !next_job_id) {
+        sq = NULL;
+        pool = NULL;
+        next_job_id = NULL;
+    }
+    sched->submit_queue = sq;
+    sched->submit_pool = pool;
+    sched->submit_next_id = next_job_id;
+}
+
+void scheduler_submit_counts(const Scheduler* sched, long long* admitted, long long* rejected) {
+    if (admitted) *admitted = sched->submissions_admitted;
+    if (rejected) *rejected = sched->submissions_rejected;
+}
+
+// Move everything waiting in the submission ring into the pending queue, a
+// batch at a time
+static void admit_submissions(Scheduler* sched, NodeList* nodes, PriorityQueue* pq, int current_time) {
+    Job* batch[SUBMIT_BATCH];
+    Job submission;
+    int popped;
     
-    // If job is complete, mark it for removal (don't remove during traversal)
-    if (job->duration == 0) {
-        job->status = 2; // Mark as completed
+    do {
+        int count = 0;
+        for (popped = 0; popped < SUBMIT_BATCH && sq_pop(sched->submit_queue, &submission); popped++) {
+            if (submission.priority < 0 || submission.duration <= 0 ||
+                submission.required_cpu <= 0 || submission.required_ram <= 0 ||
+                submission.required_cpu > nodes->max_total_cpu ||
+                submission.required_ram > nodes->max_total_ram) {
+                sched->submissions_rejected++;
+                continue;
+            }
+            
+            Job* job = jp_alloc(sched->submit_pool);
+            if (!job) {
+                sched->submissions_rejected++;
+                continue;
+            }
+            job->job_id = (*sched->submit_next_id)++;
+            job->priority = submission.priority;
+            job->required_cpu = submission.required_cpu;
+            job->required_ram = submission.required_ram;
+            job->duration = submission.duration;
+            job->status = 0; // Pending
+            job->arrival_time = current_time;
+            job->start_time = -1;
+            job->finish_time = -1;
+            batch[count++] = job;
+        }
         
-        // Find the node and release resources
-        ResourceNode* node = NULL;
-        for (int i = 0; i < ctx->nodes->size; i++) {
-            if (ctx->nodes->nodes[i]->node_id == node_id) {
-                node = ctx->nodes->nodes[i];
-                break;
+        if (pq_insert_batch(pq, batch, count)) {
+            sched->submissions_admitted += count;
+            for (int i = 0; i < count; i++) {
+                TRACE_JOB(sched, TRACE_SUBMIT, batch[i], -1, current_time);
             }
+            continue;
         }
         
-        if (node) {
-            // Release resources
-            node->available_cpu += job->required_cpu;
-            node->available_ram += job->required_ram;
+        // The batch did not fit in one go: queue what can be queued
+        for (int i = 0; i < count; i++) {
+            if (pq_find(pq, batch[i]->job_id) || pq_insert(pq, batch[i])) {
+                sched->submissions_admitted++;
+                TRACE_JOB(sched, TRACE_SUBMIT, batch[i], -1, current_time);
+            } else {
+                jp_release(sched->submit_pool, batch[i]);
+                sched->submissions_rejected++;
+            }
         }
+    } while (popped == SUBMIT_BATCH);
+}
+
+// Make the release buffer hold count releases
+static int release_reserve(Scheduler* sched, int count) {
+    if (count <= sched->releases_capacity) {
+        return 1;
+    }
+    NodeRelease* releases = (NodeRelease*)realloc(sched->releases, count * sizeof(NodeRelease));
+    if (!releases) {
+        return 0; // Released one at a time instead
+    }
+    sched->releases = releases;
+    sched->releases_capacity = count;
+    return 1;
+}
+
+// Mark a job as running on a node; the job is already out of the queue and
+// its resources are already reserved on the node
+static void start_job(Scheduler* sched, NodeList* nodes, HashTable* running_jobs, Job* job, int node_index, int current_time) {
+    // Mark job as running
+    job->status = 1;
+    job->start_time = current_time;
+    job->finish_time = current_time + job->duration;
+    METRICS_COUNT(sched, placed, 1);
+    
+    // Add to running jobs hash table
+    ResourceNode* node = nl_get(nodes, node_index);
+    if (node) {
+        ht_insert(running_jobs, job, node->node_id);
+        TRACE_JOB(sched, TRACE_PLACE, job, node->node_id, current_time);
+    }
+}
+
+// Jobs chosen while iterating the queue. The queue cannot change while it is
+// being iterated, so chosen jobs take their resources right away and leave
+// the queue afterwards
+typedef struct {
+    Job** jobs;
+    int* node_index;
+    int count;
+    int capacity;
+} StartList;
+
+static int start_list_add(StartList* list, Job* job, int node_index) {
+    if (list->count == list->capacity) {
+        int new_capacity = list->capacity ? list->capacity * 2 : 16;
+        Job** new_jobs = (Job**)realloc(list->jobs, new_capacity * sizeof(Job*));
+        if (!new_jobs) {
+            return 0;
+        }
+        list->jobs = new_jobs;
+        int* new_node_index = (int*)realloc(list->node_index, new_capacity * sizeof(int));
+        if (!new_node_index) {
+            return 0;
+        }
+        list->node_index = new_node_index;
+        list->capacity = new_capacity;
+    }
+    
+    list->jobs[list->count] = job;
+    list->node_index[list->count] = node_index;
+    list->count++;
+    return 1;
+}
+
+// Take the chosen jobs out of the queue, start them and free the list
+static void start_list_run(Scheduler* sched, StartList* list, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, int current_time) {
+    for (int i = 0; i < list->count; i++) {
+        pq_remove(pq, list->jobs[i]);
+        start_job(sched, nodes, running_jobs, list->jobs[i], list->node_index[i], current_time);
+    }
+    free(list->jobs);
+    free(list->node_index);
+}
+
+// Earliest start of the blocked head job, if running jobs finish as planned
+typedef struct {
+    int time;           // Start time (-1 if the job never fits)
+    int node_index;     // Node that fits it at that time
+    int spare_cpu;      // Resources left on that node once it starts
+    int spare_ram;
+} Reservation;
+
+// Replay running jobs in finish order, crediting their resources back to
+// their nodes, until some node fits the head job. All releases at that
+// instant are counted, and the lowest-index node that fits is reserved, so
+// the reservation does not depend on the order of simultaneous completions.
+// Only nodes that get resources back can fit the blocked head, so only those
+// are looked at, and only their scratch entries are reset afterwards
+static Reservation reserve_head(Scheduler* sched, NodeList* nodes, HashTable* running_jobs, Job* head) {
+    Reservation res = { -1, -1, 0, 0 };
+    if (!reserve_buffers(sched, nodes->size)) {
+        return res;
+    }
+    int* freed_cpu = sched->freed_cpu;
+    int* freed_ram = sched->freed_ram;
+    int freed_count = 0;
+    
+    HTFinishIterator it;
+    Job* job;
+    int node_id;
+    ht_finish_iter_init(&it, running_jobs);
+    while ((job = ht_finish_iter_next(&it, &node_id)) != NULL) {
+        if (res.time != -1 && job->finish_time > res.time) {
+            break;
+        }
+        
+        int index = nl_find_by_id(nodes, node_id);
+        if (index == -1) {
+            continue;
+        }
+        if (freed_cpu[index] == 0 && freed_ram[index] == 0) {
+            sched->freed_nodes[freed_count++] = index;
+        }
+        freed_cpu[index] += job->required_cpu;
+        freed_ram[index] += job->required_ram;
         
-        // Store job ID and node ID for removal after traversal
-        if (ctx->completed_count >= ctx->completed_capacity) {
-            // Resize arrays
-            int new_capacity = ctx->completed_capacity * 2;
-            if (new_capacity == 0) new_capacity = 10;
-            ctx->completed_job_ids = (int*)realloc(ctx->completed_job_ids, new_capacity * sizeof(int));
-            ctx->completed_node_ids = (int*)realloc(ctx->completed_node_ids, new_capacity * sizeof(int));
-            if (ctx->completed_job_ids && ctx->completed_node_ids) {
-                ctx->completed_capacity = new_capacity;
+        ResourceNode* node = nl_get(nodes, index);
+        if (res.time == -1 &&
+            node->available_cpu + freed_cpu[index] >= head->required_cpu &&
+            node->available_ram + freed_ram[index] >= head->required_ram) {
+            res.time = job->finish_time;
+        }
+    }
+    ht_finish_iter_free(&it);
+    
+    for (int i = 0; i < freed_count; i++) {
+        int index = sched->freed_nodes[i];
+        ResourceNode* node = nl_get(nodes, index);
+        if (res.time != -1 && (res.node_index == -1 || index < res.node_index) &&
+            node->available_cpu + freed_cpu[index] >= head->required_cpu &&
+            node->available_ram + freed_ram[index] >= head->required_ram) {
+            res.node_index = index;
+            res.spare_cpu = node->available_cpu + freed_cpu[index] - head->required_cpu;
+            res.spare_ram = node->available_ram + freed_ram[index] - head->required_ram;
+        }
+    }
+    for (int i = 0; i < freed_count; i++) {
+        freed_cpu[sched->freed_nodes[i]] = 0;
+        freed_ram[sched->freed_nodes[i]] = 0;
+    }
+    return res;
+}
+
+// Start jobs behind the blocked head that fit now and either finish before
+// the head's reservation or leave its reserved resources alone. The scan
+// stops after backfill_depth searches found no usable node, so deep queues
+// stay cheap; jobs whose shape is already known to fit nowhere are skipped
+// without a search and do not count. Until a job completes, repeating the pass starts nothing new,
+// which keeps fast-forwarding exact
+static void backfill(Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, int current_time) {
+    Job* head = pq_peek(pq);
+    Reservation res = reserve_head(sched, nodes, running_jobs, head);
+    
+    StartList started = { NULL, NULL, 0, 0 };
+    int rejected = 0;
+    PQIterator it;
+    Job* job;
+    pq_iter_init(&it, pq);
+    pq_iter_next(&it); // Skip the head job
+    while (rejected < sched->backfill_depth && (job = pq_iter_next(&it)) != NULL) {
+        if (!nl_has_free_capacity(nodes)) {
+            break; // Every node is full
+        }
+        
+        // A shape already known to fit nowhere costs no search, so it does
+        // not count against the depth: a run of identical blocked jobs
+        // cannot hide a different shape behind it
+        int known_no_fit = nl_known_no_fit(nodes, job);
+        int node_index = known_no_fit ? -1 : nl_find_available_node(nodes, job);
+        METRICS_ATTEMPT(sched, node_index);
+        if (node_index != -1 && res.time != -1 && current_time + job->duration > res.time &&
+            node_index == res.node_index) {
+            // Still running when the head starts, on the head's node: only
+            // the resources the head leaves over may be used there
+            if (job->required_cpu <= res.spare_cpu && job->required_ram <= res.spare_ram) {
+                res.spare_cpu -= job->required_cpu;
+                res.spare_ram -= job->required_ram;
             } else {
-                return; // Failed to allocate
+                node_index = nl_find_available_node_except(nodes, job, res.node_index);
+                METRICS_ATTEMPT(sched, node_index);
             }
         }
+        if (node_index == -1) {
+            rejected += !known_no_fit;
+            continue;
+        }
         
-        ctx->completed_job_ids[ctx->completed_count] = job->job_id;
-        ctx->completed_node_ids[ctx->completed_count] = node_id;
-        ctx->completed_count++;
+        if (!start_list_add(&started, job, node_index)) {
+            break;
+        }
+        nl_reserve(nodes, node_index, job->required_cpu, job->required_ram);
     }
+    pq_iter_free(&it);
+    
+    // Every backfilled job starts ahead of the waiting head
+    sched->out_of_order_starts += started.count;
+    start_list_run(sched, &started, nodes, pq, running_jobs, current_time);
 }
 
-void run_scheduler_tick(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int current_time) {
-    (void)current_time; // Suppress unused parameter warning (reserved for future use)
-    if (!nodes || !pq || !running_jobs || !completed_jobs) {
+void run_scheduler_tick(Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int current_time) {
+    if (!sched || !nodes || !pq || !running_jobs || !completed_jobs) {
         return;
     }
     
-    // Phase 1: Update Running Jobs
-    UpdateContext ctx;
-    ctx.nodes = nodes;
-    ctx.running_jobs = running_jobs;
-    ctx.completed_jobs = completed_jobs;
-    ctx.completed_job_ids = NULL;
-    ctx.completed_node_ids = NULL;
-    ctx.completed_count = 0;
-    ctx.completed_capacity = 0;
-    
-    // Traverse the hash table to update all running jobs
-    // This collects completed job IDs without modifying the hash table
-    ht_traverse(running_jobs, update_running_job, &ctx);
-    
-    // Now remove completed jobs from hash table and add to completed list
-    for (int i = 0; i < ctx.completed_count; i++) {
-        Job* completed_job = ht_remove(running_jobs, ctx.completed_job_ids[i]);
-        if (completed_job) {
+    METRICS_TICK_BEGIN(sched);
+    
+    // Phase 0: Admit Submitted Jobs
+    if (sched->submit_queue) {
+        METRICS_NOW(admit_start);
+        TRACE_NOW(sched, trace_admit_start);
+        admit_submissions(sched, nodes, pq, current_time);
+        METRICS_PHASE_END(sched, METRICS_PHASE_ADMIT, admit_start);
+        TRACE_PHASE(sched, METRICS_PHASE_ADMIT, trace_admit_start, current_time);
+    }
+    
+    // Phase 1: Complete Running Jobs
+    // Running jobs are ordered by absolute finish time, so only the jobs
+    // that finish on this tick are touched. Each shard's due jobs are
+    // collected on the worker threads and merged in (finish_time, job_id)
+    // order; their resources go back to the nodes in one batch, split by
+    // node position across the threads, and the jobs enter the history in
+    // that order here
+    METRICS_NOW(complete_start);
+    TRACE_NOW(sched, trace_complete_start);
+    FinishedJob* finished;
+    int count;
+    while ((count = ht_drain_finished(running_jobs, current_time, sched->workers, &finished)) > 0) {
+        int batched = release_reserve(sched, count);
+        int releases = 0;
+        for (int i = 0; i < count; i++) {
+            Job* completed_job = finished[i].job;
+            int node_index = nl_find_by_id(nodes, finished[i].node_id);
+            if (node_index == -1) {
+                continue;
+            }
+            if (batched) {
+                NodeRelease* release = &sched->releases[releases++];
+                release->index = node_index;
+                release->cpu = completed_job->required_cpu;
+                release->ram = completed_job->required_ram;
+            } else {
+                nl_release(nodes, node_index, completed_job->required_cpu, completed_job->required_ram);
+            }
+        }
+        nl_release_batch(nodes, sched->releases, releases, sched->workers);
+        
+        for (int i = 0; i < count; i++) {
+            Job* completed_job = finished[i].job;
+            completed_job->status = 2; // Mark as completed
+            TRACE_JOB(sched, TRACE_COMPLETE, completed_job, finished[i].node_id, current_time);
             jl_add(completed_jobs, completed_job);
         }
+        METRICS_COUNT(sched, completed, count);
     }
-    
-    // Free temporary arrays
-    free(ctx.completed_job_ids);
-    free(ctx.completed_node_ids);
+    METRICS_PHASE_END(sched, METRICS_PHASE_COMPLETE, complete_start);
+    TRACE_PHASE(sched, METRICS_PHASE_COMPLETE, trace_complete_start, current_time);
     
     // Phase 2: Schedule New Jobs
-    // Try to schedule as many jobs as possible (backfilling)
+    // Skipped when neither the queue nor node capacity changed since the
+    // last pass: it would start nothing
+    if (sched->placement_valid && pq->version == sched->seen_queue_version &&
+        nodes->capacity_epoch == sched->seen_capacity_epoch) {
+        sched->passes_skipped++;
+        METRICS_TICK_END(sched, nodes, pq, running_jobs, current_time);
+        TRACE_COUNTERS(sched, pq, running_jobs, current_time);
+        return;
+    }
+    sched->passes_run++;
+    METRICS_NOW(place_start);
+    TRACE_NOW(sched, trace_place_start);
+    
+    // Start jobs in priority order while the highest priority job fits
     while (1) {
         // Peek at the highest priority job
         Job* job = pq_peek(pq);
@@ -106,36 +451,81 @@ void run_scheduler_tick(NodeList* nodes, PriorityQueue* pq, HashTable* running_j
         
         // Search for an available node
         int node_index = nl_find_available_node(nodes, job);
-        
-        if (node_index != -1) {
-            // Found an available node, schedule the job
-            Job* job_to_run = pq_extract_min(pq);
-            if (!job_to_run) {
-                break; // Should not happen, but safety check
+        METRICS_ATTEMPT(sched, node_index);
+        if (node_index == -1) {
+            // The head job does not fit: reserve its earliest start and let
+            // jobs behind it start if they cannot delay that reservation
+            // (EASY backfilling)
+            if (sched->backfill_depth > 0) {
+                backfill(sched, nodes, pq, running_jobs, current_time);
             }
-            
-            // Mark job as running
-            job_to_run->status = 1;
-            
-            // Deduct resources from the node
-            ResourceNode* node = nl_get(nodes, node_index);
-            if (node) {
-                node->available_cpu -= job_to_run->required_cpu;
-                node->available_ram -= job_to_run->required_ram;
-                
-                // Add to running jobs hash table
-                ht_insert(running_jobs, job_to_run, node->node_id);
+            break;
+        }
+        
+        Job* job_to_run = pq_extract_min(pq);
+        nl_reserve(nodes, node_index, job_to_run->required_cpu, job_to_run->required_ram);
+        start_job(sched, nodes, running_jobs, job_to_run, node_index, current_time);
+    }
+    
+    sched->placement_valid = 1;
+    sched->seen_queue_version = pq->version;
+    sched->seen_capacity_epoch = nodes->capacity_epoch;
+    
+    METRICS_PHASE_END(sched, METRICS_PHASE_PLACE, place_start);
+    TRACE_PHASE(sched, METRICS_PHASE_PLACE, trace_place_start, current_time);
+    METRICS_TICK_END(sched, nodes, pq, running_jobs, current_time);
+    TRACE_COUNTERS(sched, pq, running_jobs, current_time);
+}
+
+int run_scheduler_until(Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int* current_time, int end_time, int stop_when_idle) {
+    if (!sched || !nodes || !pq || !running_jobs || !completed_jobs || !current_time) {
+        return 0;
+    }
+    
+    int passes = 0;
+    int time = *current_time;
+    
+    // The first tick always runs: jobs submitted since the last tick may fit now
+    if (time < end_time) {
+        time++;
+        run_scheduler_tick(sched, nodes, pq, running_jobs, completed_jobs, time);
+        passes++;
+    }
+    
+    // After that nothing changes until the next running job completes, so
+    // every tick in between would be a no-op and can be skipped
+    while (time < end_time) {
+        if (sched->submit_queue && sq_has_ready(sched->submit_queue)) {
+            // Jobs were submitted: admit them on the next tick
+            time++;
+            run_scheduler_tick(sched, nodes, pq, running_jobs, completed_jobs, time);
+            passes++;
+            continue;
+        }
+        
+        int next_finish = ht_next_finish_time(running_jobs);
+        if (next_finish == -1) {
+            if (stop_when_idle) {
+                break; // Nothing running, nothing will free up
             }
-            
-            // Continue loop to try scheduling the next job (backfilling)
-        } else {
-            // No available node found, break the loop
+            time = end_time;
             break;
         }
+        if (next_finish > end_time) {
+            time = end_time;
+            break;
+        }
+        
+        time = next_finish > time ? next_finish : time + 1;
+        run_scheduler_tick(sched, nodes, pq, running_jobs, completed_jobs, time);
+        passes++;
     }
+    
+    *current_time = time;
+    return passes;
 }
 
-void print_status(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs) {
+void print_status(const Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int current_time) {
     printf("\n=== Scheduler Status ===\n\n");
     
     // Print nodes
@@ -157,18 +547,12 @@ void print_status(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, J
     if (pq_is_empty(pq)) {
         printf("  (none)\n");
     } else {
-        // Create a temporary priority queue to print without modifying the original
-        PriorityQueue* temp_pq = pq_create(pq->capacity);
-        if (temp_pq) {
-            // Copy jobs (we'll just print the count and peek at top)
-            printf("  Total: %d jobs\n", pq_size(pq));
-            Job* top = pq_peek(pq);
-            if (top) {
-                printf("  Next: Job %d (Priority=%d, CPU=%d, RAM=%d, Duration=%d)\n",
-                       top->job_id, top->priority, top->required_cpu,
-                       top->required_ram, top->duration);
-            }
-            pq_free(temp_pq);
+        printf("  Total: %d jobs\n", pq_size(pq));
+        Job* top = pq_peek(pq);
+        if (top) {
+            printf("  Next: Job %d (Priority=%d, CPU=%d, RAM=%d, Duration=%d)\n",
+                   top->job_id, top->priority, top->required_cpu,
+                   top->required_ram, top->duration);
         }
     }
     
@@ -180,18 +564,18 @@ void print_status(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, J
     } else {
         printf("  Total: %d jobs\n", running_count);
         // Print all running jobs
-        for (int i = 0; i < running_jobs->size; i++) {
-            HashNode* current = running_jobs->table[i];
-            while (current) {
-                printf("  Job %d: Priority=%d, CPU=%d, RAM=%d, Duration=%d (Node %d)\n",
-                       current->job->job_id,
-                       current->job->priority,
-                       current->job->required_cpu,
-                       current->job->required_ram,
-                       current->job->duration,
-                       current->node_id);
-                current = current->next;
+        for (int i = 0; i < running_jobs->capacity; i++) {
+            HashNode* current = &running_jobs->table[i];
+            if (!current->job) {
+                continue; // Empty slot
             }
+            printf("  Job %d: Priority=%d, CPU=%d, RAM=%d, Duration=%d (Node %d)\n",
+                   current->job->job_id,
+                   current->job->priority,
+                   current->job->required_cpu,
+                   current->job->required_ram,
+                   current->job->finish_time - current_time,
+                   current->node_id);
         }
     }
     
@@ -199,6 +583,17 @@ void print_status(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, J
     printf("\nCompleted Jobs:\n");
     jl_print(completed_jobs);
     
+    // Print placement pass counters
+    printf("\nScheduler:\n");
+    printf("  Placement passes: %lld run, %lld skipped (nothing changed)\n",
+           sched->passes_run, sched->passes_skipped);
+    printf("  Out-of-order starts: %lld (ahead of a waiting higher priority job)\n",
+           sched->out_of_order_starts);
+    if (sched->submit_queue) {
+        printf("  Submissions: %lld admitted, %lld rejected\n",
+               sched->submissions_admitted, sched->submissions_rejected);
+    }
+    
     printf("\n");
 }
 
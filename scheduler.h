@@ -6,14 +6,119 @@
 #include "priority_queue.h"
 #include "hash_table.h"
 #include "job_list.h"
+#include "job_pool.h"
+#include "submit_queue.h"
+#include "worker_pool.h"
+#include "metrics.h"
+#include "trace.h"
+
+// Pending jobs examined behind a blocked head job by default
+#define DEFAULT_BACKFILL_DEPTH 64
+
+// Scheduler settings and the state it carries from one tick to the next.
+// Every entry point takes one, so separate simulations (or a test harness
+// next to the interactive one) never share counters, metrics, traces or
+// dirty tracking
+struct Scheduler {
+    int backfill_depth;     // Pending jobs examined behind a blocked head job
+    WorkerPool* workers;    // Threads collecting due completions (NULL = serial)
+    // Dirty tracking: a placement pass that ran to completion is repeated
+    // with the same outcome (nothing starts) until a job is queued, removed
+    // or moved, or some node gains capacity, so Phase 2 is skipped until one
+    // of these versions moves
+    int placement_valid;
+    unsigned int seen_queue_version;
+    unsigned int seen_capacity_epoch;
+    long long passes_run;
+    long long passes_skipped;
+    long long out_of_order_starts; // Started while a higher priority job waited
+    // Submission ring drained at the start of each tick (NULL = none)
+    SubmitQueue* submit_queue;
+    JobPool* submit_pool;
+    int* submit_next_id;
+    long long submissions_admitted;
+    long long submissions_rejected;
+    // Backfill reservation scratch: resources the finish-order replay has
+    // credited back per node index (all zero between passes), and the
+    // indices it touched
+    int* freed_cpu;
+    int* freed_ram;
+    int* freed_nodes;
+    int freed_capacity;
+    // Node releases of the completions being applied (nl_release_batch)
+    NodeRelease* releases;
+    int releases_capacity;
+    SchedulerMetrics metrics;   // Tick timings and counters (metrics.h)
+    Tracer trace;               // Timeline recorder, off until trace_start (trace.h)
+};
+
+// Create a scheduler with the default settings and no ring attached
+Scheduler* scheduler_create(void);
+
+// Free the scheduler and its scratch buffers (not the structures it was run on)
+void scheduler_free(Scheduler* sched);
+
+// Collect each tick's due completions on this many threads (1 = serial, the
+// default; at most HT_EVENT_SHARDS are useful). Completions are still applied
+// in (finish_time, job_id) order, so the outcome does not depend on it
+// Returns 1 on success, 0 if the threads cannot be started (the setting is
+// then unchanged) or this build has no thread support
+int scheduler_set_threads(Scheduler* sched, int threads);
+int scheduler_threads(const Scheduler* sched);
+
+// Set how many pending jobs behind a blocked head job are considered for
+// backfilling (0 = strict head-of-line scheduling)
+void scheduler_set_backfill_depth(Scheduler* sched, int depth);
+int scheduler_backfill_depth(const Scheduler* sched);
+
+// Attach a submission ring filled by other threads. Each tick first admits
+// everything submitted so far into the pending queue, allocating jobs from
+// pool and numbering them from *next_job_id in the order they are read.
+// Submissions that no node could ever fit (or with non-positive resources or
+// duration, or a negative priority) are dropped and counted as rejected.
+// Pass NULL to detach
+void scheduler_attach_submit_queue(Scheduler* sched, SubmitQueue* sq, JobPool* pool, int* next_job_id);
+
+// Number of ring submissions admitted to the queue and rejected
+void scheduler_submit_counts(const Scheduler* sched, long long* admitted, long long* rejected);
+
+// Force the next tick to run its placement pass. Phase 2 is otherwise skipped
+// while the pending queue and node capacity are unchanged since the last
+// pass; call this when the structures are replaced (load) or a setting that
+// affects placement changes
+void scheduler_invalidate(Scheduler* sched);
+
+// Number of placement passes run and skipped by dirty tracking
+void scheduler_pass_counts(const Scheduler* sched, long long* run, long long* skipped);
+
+// How far placement strayed from strict priority order: jobs started while
+// a higher priority job was left waiting in the same pass (backfilling)
+long long scheduler_out_of_order_starts(const Scheduler* sched);
 
 // Run one tick of the scheduler
-// Phase 1: Update running jobs (decrement duration, move completed jobs)
-// Phase 2: Schedule new jobs from priority queue
-void run_scheduler_tick(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int current_time);
+// Phase 0: Admit jobs from the attached submission ring, if any
+// Phase 1: Complete running jobs whose finish time is <= current_time (when
+// threads are set, due completions are collected from the running set's
+// shards and their node releases applied in parallel; the jobs then enter
+// the history in order)
+// Phase 2: Schedule new jobs from priority queue. When the highest priority
+// job does not fit, it gets a reservation at the earliest time running jobs
+// free enough resources, and jobs behind it may start if they cannot delay
+// that reservation (EASY backfilling)
+void run_scheduler_tick(Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int current_time);
+
+// Advance the simulation from *current_time towards end_time, running the
+// scheduler only at the instants where its outcome can change (the next tick,
+// then each job completion). The final state is identical to running one tick
+// at a time. Ticks are not skipped while the attached submission ring has
+// jobs waiting. With stop_when_idle, stops early once no jobs are running.
+// *current_time is updated to the final time; returns the number of ticks on
+// which the scheduler actually ran.
+int run_scheduler_until(Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int* current_time, int end_time, int stop_when_idle);
 
 // Print the status of all queues and nodes
-void print_status(NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs);
+// Running jobs show their remaining duration relative to current_time
+void print_status(const Scheduler* sched, NodeList* nodes, PriorityQueue* pq, HashTable* running_jobs, JobList* completed_jobs, int current_time);
 
 #endif // SCHEDULER_H
 
@@ -0,0 +1,181 @@
+// Stress test for the submission ring: several producer threads submit jobs
+// while the scheduler thread ticks, then every job is checked to have been
+// admitted exactly once and in each producer's submission order.
+// Usage: ./stress_test [producers] [jobs_per_producer]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include "scheduler.h"
+
+#define DEFAULT_PRODUCERS 4
+#define DEFAULT_JOBS_PER_PRODUCER 50000
+#define RING_CAPACITY 1024      // Small, so producers regularly find it full
+#define NODE_COUNT 16
+
+typedef struct {
+    SubmitQueue* sq;
+    int producer;
+    int jobs;
+    atomic_int* finished;
+} Producer;
+
+// Each job carries its producer in required_cpu and its sequence number in
+// required_ram, so the admitted jobs can be matched back to submissions
+static void* produce(void* arg) {
+    Producer* p = (Producer*)arg;
+    Job job;
+    job.priority = 0;
+    job.duration = 1;
+    job.required_cpu = p->producer + 1;
+    
+    for (int seq = 0; seq < p->jobs; seq++) {
+        job.required_ram = seq + 1;
+        while (!sq_push(p->sq, &job)) {
+            sched_yield(); // Full: let the scheduler catch up
+        }
+    }
+    
+    atomic_fetch_add(p->finished, 1);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    int producers = argc > 1 ? atoi(argv[1]) : DEFAULT_PRODUCERS;
+    int jobs = argc > 2 ? atoi(argv[2]) : DEFAULT_JOBS_PER_PRODUCER;
+    if (producers <= 0 || jobs <= 0) {
+        fprintf(stderr, "Usage: %s [producers] [jobs_per_producer]\n", argv[0]);
+        return 1;
+    }
+    
+    JobPool* pool = jp_create();
+    NodeList* nodes = nl_create(NODE_COUNT);
+    PriorityQueue* pq = pq_create(1024);
+    HashTable* running_jobs = ht_create(1024);
+    JobList* completed_jobs = jl_create(pool);
+    SubmitQueue* sq = sq_create(RING_CAPACITY);
+    Scheduler* sched = scheduler_create();
+    char* seen = (char*)calloc((size_t)producers * jobs, sizeof(char));
+    Producer* threads = (Producer*)malloc(producers * sizeof(Producer));
+    pthread_t* ids = (pthread_t*)malloc(producers * sizeof(pthread_t));
+    if (!pool || !nodes || !pq || !running_jobs || !completed_jobs || !sq || !sched ||
+        !seen || !threads || !ids) {
+        fprintf(stderr, "Error: Failed to allocate memory\n");
+        return 1;
+    }
+    
+    for (int i = 0; i < NODE_COUNT; i++) {
+        ResourceNode* node = (ResourceNode*)malloc(sizeof(ResourceNode));
+        if (!node) {
+            fprintf(stderr, "Error: Failed to allocate memory for node\n");
+            return 1;
+        }
+        node->node_id = i + 1;
+        node->total_cpu = node->available_cpu = producers * 64;
+        node->total_ram = node->available_ram = jobs * 8;
+        nl_add(nodes, node);
+    }
+    
+    int next_job_id = 1;
+    scheduler_attach_submit_queue(sched, sq, pool, &next_job_id);
+    
+    atomic_int finished;
+    atomic_init(&finished, 0);
+    for (int i = 0; i < producers; i++) {
+        threads[i].sq = sq;
+        threads[i].producer = i;
+        threads[i].jobs = jobs;
+        threads[i].finished = &finished;
+        if (pthread_create(&ids[i], NULL, produce, &threads[i]) != 0) {
+            fprintf(stderr, "Error: Failed to start producer %d\n", i);
+            return 1;
+        }
+    }
+    
+    // Tick until every producer is done and everything submitted has run
+    int current_time = 0;
+    while (atomic_load(&finished) < producers || sq_has_ready(sq) ||
+           !pq_is_empty(pq) || ht_size(running_jobs) > 0) {
+        if (!sq_has_ready(sq) && pq_is_empty(pq) && ht_size(running_jobs) == 0) {
+            sched_yield(); // Idle: let the producers run
+            continue;
+        }
+        run_scheduler_tick(sched, nodes, pq, running_jobs, completed_jobs, ++current_time);
+    }
+    
+    for (int i = 0; i < producers; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    
+    // Every submission must have completed exactly once, and each producer's
+    // jobs must have been numbered in the order it submitted them
+    int errors = 0;
+    for (int i = 0; i < jl_size(completed_jobs); i++) {
+        Job* job = jl_get(completed_jobs, i);
+        int producer = job->required_cpu - 1;
+        int seq = job->required_ram - 1;
+        if (producer < 0 || producer >= producers || seq < 0 || seq >= jobs) {
+            errors++;
+            continue;
+        }
+        if (seen[(size_t)producer * jobs + seq]++) {
+            errors++; // Duplicate
+        }
+    }
+    for (int i = 0; i < producers; i++) {
+        for (int seq = 0; seq < jobs; seq++) {
+            if (!seen[(size_t)i * jobs + seq]) {
+                errors++; // Lost
+            }
+        }
+    }
+    
+    // Submission order: ids must grow with each producer's sequence numbers
+    int* id_of = (int*)malloc((size_t)producers * jobs * sizeof(int));
+    if (id_of) {
+        for (int i = 0; i < jl_size(completed_jobs); i++) {
+            Job* job = jl_get(completed_jobs, i);
+            int producer = job->required_cpu - 1;
+            int seq = job->required_ram - 1;
+            if (producer >= 0 && producer < producers && seq >= 0 && seq < jobs) {
+                id_of[(size_t)producer * jobs + seq] = job->job_id;
+            }
+        }
+        for (int i = 0; i < producers && !errors; i++) {
+            for (int seq = 1; seq < jobs; seq++) {
+                if (id_of[(size_t)i * jobs + seq] <= id_of[(size_t)i * jobs + seq - 1]) {
+                    errors++; // Reordered
+                }
+            }
+        }
+        free(id_of);
+    }
+    
+    long long admitted, rejected;
+    scheduler_submit_counts(sched, &admitted, &rejected);
+    printf("%d producers x %d jobs: %lld admitted, %lld rejected, %d completed in %d ticks\n",
+           producers, jobs, admitted, rejected, jl_size(completed_jobs), current_time);
+    int ok = errors == 0 && admitted == (long long)producers * jobs && rejected == 0;
+    if (ok) {
+        printf("OK: no loss or duplication\n");
+    } else {
+        printf("FAILED: %d lost, duplicated or reordered jobs\n", errors);
+    }
+    
+    scheduler_free(sched);
+    for (int i = 0; i < nl_size(nodes); i++) {
+        free(nl_get(nodes, i));
+    }
+    nl_free(nodes);
+    pq_free(pq);
+    ht_free(running_jobs);
+    jl_free(completed_jobs);
+    jp_free(pool);
+    sq_free(sq);
+    free(seen);
+    free(threads);
+    free(ids);
+    
+    return ok ? 0 : 1;
+}
@@ -2,16 +2,38 @@
 #define STRUCTS_H
 
 // A single job
-typedef struct {
+typedef struct Job {
     int job_id;
     int priority;       // Lower number = higher priority
     int required_cpu;
     int required_ram;
-    int duration;       // Time ticks remaining
+    int duration;       // Run time in ticks
     int status;         // 0=Pending, 1=Running, 2=Completed
     int arrival_time;   // Time when job was added
+    int start_time;     // Time when job was placed on a node
+    int finish_time;    // Time when job completes (start_time + duration)
+    int handle;         // Slot of the job in its JobPool
+    int queue_index;    // Slot in the pending heap (-1 if bucketed or not queued)
+    struct Job* queue_next; // Neighbours in the same priority bucket (bucket queue)
+    struct Job* queue_prev;
 } Job;
 
+// --- JobPool (Slab Allocator for Jobs) ---
+// Jobs are carved out of fixed-size slabs that never move, so Job pointers
+// stay valid and a job can also be referenced by its integer handle
+// (slab * JOB_POOL_SLAB_SIZE + slot). Released jobs are kept on a free list
+// threaded through their handle field.
+#define JOB_POOL_SLAB_SIZE 1024
+
+typedef struct {
+    Job** slabs;
+    int slab_count;
+    int slab_capacity;
+    int next_unused;    // Handle of the next never-used job (bump pointer)
+    int free_head;      // Handle of the most recently released job, or -1
+    int live;           // Number of jobs currently allocated
+} JobPool;
+
 // A single server node
 typedef struct {
     int node_id;
@@ -22,41 +44,236 @@ typedef struct {
 } ResourceNode;
 
 // --- NodeList (Dynamic Array for ResourceNodes) ---
+// Strategy used to choose among the nodes that can fit a job
+typedef enum {
+    PLACEMENT_FIRST_FIT,    // Lowest-index node that fits
+    PLACEMENT_BEST_FIT,     // Node left with the least free capacity
+    PLACEMENT_WORST_FIT,    // Node left with the most free capacity
+    PLACEMENT_DOT_PRODUCT   // Node whose free capacity best aligns with the job
+} PlacementPolicy;
+
+// Capacity summary of a subtree of the node index
+typedef struct {
+    int max_cpu;
+    int max_ram;
+    int min_cpu;
+    int min_ram;
+} CapacitySummary;
+
+// The capacity index is a segment tree over node positions: leaf i holds the
+// available CPU/RAM of nodes[i] and every internal entry summarizes its
+// children, so fitting nodes can be found without scanning the array.
+// Jobs with the same (required_cpu, required_ram) share a shape class. Once a
+// shape fails to fit on any node it cannot fit again until some node gains
+// capacity, so failed shapes are remembered in a small open-addressing set
+// that is cleared whenever capacity_epoch moves (a release or a new node).
+#define NL_NO_FIT_SLOTS 256
+
+typedef struct {
+    int cpu;            // 0 marks an empty slot
+    int ram;
+} JobShape;
+
+// Resources handed back to the node at index (see nl_release_batch). A batch
+// is applied in NL_RELEASE_CHUNKS chunks of adjacent node positions, each a
+// subtree of the capacity index, so chunks can be applied on different
+// threads; only the few index entries above the chunks are shared
+#define NL_RELEASE_CHUNKS 16
+
+typedef struct {
+    int index;
+    int cpu;
+    int ram;
+} NodeRelease;
+
+// Best fit keeps a second index: a treap over node positions ordered by free
+// CPU, then free RAM, where every entry also holds the largest free RAM in its
+// subtree. The first node with at least c CPU that fits is found in O(log n)
+// and is the best fit among the nodes with that much CPU free, so a lookup
+// steps through the distinct free-CPU levels from c upward until no level can
+// leave less behind. It is built on the first best-fit lookup and kept up to
+// date from then on.
+typedef struct {
+    int cpu;            // Free capacity when inserted (the sort key)
+    int ram;
+    unsigned int priority;
+    int left;           // Child positions (-1 = none)
+    int right;
+    int max_ram;        // Largest free RAM in the subtree
+} FitEntry;
+
 typedef struct {
     ResourceNode** nodes;
     int size;
     int capacity;
+    CapacitySummary* index; // Segment tree (2 * leaves entries, root at 1)
+    int leaves;             // Number of leaves, a power of two >= capacity
+    int max_total_cpu;      // Largest node, used to normalize placement scores
+    int max_total_ram;
+    PlacementPolicy policy;
+    unsigned int capacity_epoch; // Bumped whenever some node gains capacity
+    JobShape* no_fit;       // Shapes known not to fit (NL_NO_FIT_SLOTS slots)
+    int no_fit_count;
+    unsigned int no_fit_epoch;   // capacity_epoch the no_fit set is valid for
+    FitEntry* fit;          // Best-fit order (capacity entries, NULL until built)
+    int fit_root;           // Root position (-1 = empty)
+    int fit_ready;          // 0 = rebuild before the next best-fit lookup
+    NodeRelease* release_order; // nl_release_batch scratch, grouped by chunk
+    int release_capacity;
 } NodeList;
 
-// --- PriorityQueue (Min-Heap for Pending Jobs) ---
+// --- HashTable (for Running Jobs, using Robin Hood Open Addressing) ---
+// One slot of the table; entries live inline, so no per-entry allocation
 typedef struct {
-    Job** jobs;
-    int size;
-    int capacity;
-} PriorityQueue;
+    int job_id;
+    Job* job;       // NULL marks an empty slot
+    int node_id;    // Track which node this job is on
+    int distance;   // Probe distance from the entry's home slot
+} HashNode;
 
-// --- HashTable (for Running Jobs, using Separate Chaining) ---
-typedef struct HashNode {
+// Completion event: a running job keyed by absolute finish time
+typedef struct {
+    int finish_time;
     int job_id;
+    int node_id;
+} CompletionEvent;
+
+// A running job removed from the table because it finished
+typedef struct {
     Job* job;
-    int node_id; // Track which node this job is on
-    struct HashNode* next;
-} HashNode;
+    int node_id;
+} FinishedJob;
+
+// Completion events are split into shards by job_id, each its own min-heap
+// ordered by (finish_time, job_id). A tick's due events are collected shard
+// by shard (in parallel when a worker pool is given) and merged back into
+// one (finish_time, job_id) order, so the result never depends on how many
+// threads did the work
+#define HT_EVENT_SHARDS 16
 
 typedef struct {
-    int size;
-    HashNode** table;
+    CompletionEvent* events;    // Min-heap of this shard's running jobs
+    int count;
+    int capacity;
+    // Events taken out by the last drain, in (finish_time, job_id) order
+    CompletionEvent* due;
+    int due_count;
+    int due_capacity;
+    int truncated;  // The due buffer could not grow, so due events remain
+} EventShard;
+
+typedef struct {
+    int capacity;   // Number of slots, always a power of two
+    int count;      // Number of occupied slots
+    HashNode* table;
+    EventShard shards[HT_EVENT_SHARDS];
+    // Buffer returned by ht_drain_finished
+    FinishedJob* finished;
+    int finished_capacity;
 } HashTable;
 
-// --- JobList (Linked List for Completed Jobs) ---
-typedef struct JobNode {
-    Job* job;
-    struct JobNode* next;
-} JobNode;
+// --- PriorityQueue (Pending Jobs) ---
+// Jobs are ordered by priority, then arrival_time, then job_id, so
+// equal-priority jobs leave in arrival order with either implementation.
+// Every queued job is also indexed by id, and heap jobs know their slot
+// (queue_index), so any pending job can be removed or moved in O(log n).
+typedef enum {
+    PQ_KIND_HEAP,       // Binary min-heap, O(log n) insert and extract-min
+    PQ_KIND_BUCKET      // FIFO list per priority level, O(1) insert and extract-min
+} QueueKind;
+
+// Priorities 0..PQ_BUCKET_LEVELS-1 get their own bucket; others fall back
+// to the heap, as does a reprioritized job that is older than its new
+// level's tail, so lists only ever grow at the tail. A bitmap of non-empty
+// levels (plus a summary word with one bit per bitmap word) finds the
+// lowest level with two bit scans.
+#define PQ_BUCKET_LEVELS 4096
+#define PQ_BUCKET_WORDS (PQ_BUCKET_LEVELS / 64)
 
+// Pending jobs by id: an open-addressing map from job_id to Job* (linear
+// probing, backward-shift deletion), sized to stay at most half full
 typedef struct {
-    JobNode* head;
-    int size;
+    Job** slots;        // NULL marks an empty slot
+    int capacity;       // Power of two
+    int count;
+} JobIndex;
+
+typedef struct {
+    Job** jobs;         // Binary heap (the overflow heap for the bucket kind)
+    int size;           // Jobs in the heap
+    int capacity;
+    QueueKind kind;
+    Job** bucket_head;  // Per-level FIFO lists linked through queue_next/prev
+    Job** bucket_tail;
+    unsigned long long* level_bits;   // Bit per non-empty level
+    unsigned long long level_summary; // Bit per non-zero level_bits word
+    int bucket_count;   // Jobs in buckets
+    JobIndex index;     // job_id -> pending job, for cancel and reprioritize
+    int aging;          // Ticks of waiting worth one priority level (0 = off)
+    unsigned int version; // Bumped whenever the queue's contents or order change
+} PriorityQueue;
+
+// --- JobList (Chunked History of Completed Jobs) ---
+// Completed jobs are appended into fixed-size chunks of job pointers. Only the
+// most recent `retention` jobs are kept in memory; older ones are evicted
+// (returned to the pool) a chunk at a time, while the aggregate counters keep
+// covering every job ever completed.
+#define JOB_LIST_CHUNK_SIZE 256
+
+typedef struct {
+    Job* jobs[JOB_LIST_CHUNK_SIZE];
+} JobChunk;
+
+// Aggregates over every completed job, including evicted ones
+typedef struct {
+    long long completed;
+    long long total_wait;        // Sum of (start_time - arrival_time)
+    long long total_turnaround;  // Sum of (finish_time - arrival_time)
+    long long cpu_ticks;         // Sum of required_cpu * duration
+    long long ram_ticks;         // Sum of required_ram * duration
+} CompletionStats;
+
+// Log-bucketed histogram of non-negative tick counts (HDR-style): values
+// below 2 * HISTOGRAM_SUB_BUCKETS get a bucket each, and every power of two
+// above that is split into HISTOGRAM_SUB_BUCKETS equal buckets, so any int
+// is recorded with a relative error under 1 / HISTOGRAM_SUB_BUCKETS in a
+// fixed HISTOGRAM_BUCKETS counters
+#define HISTOGRAM_SUB_BUCKET_BITS 5
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKETS ((32 - HISTOGRAM_SUB_BUCKET_BITS) * HISTOGRAM_SUB_BUCKETS)
+
+typedef struct {
+    long long count;
+    long long sum;
+    int min;
+    int max;
+    long long buckets[HISTOGRAM_BUCKETS];
+} Histogram;
+
+// Wait and turnaround histograms per priority level. Priorities 0 to
+// LATENCY_TOP_PRIORITY - 1 have their own; higher ones share the class at
+// LATENCY_TOP_PRIORITY, and LATENCY_ALL covers every job
+#define LATENCY_TOP_PRIORITY 32
+#define LATENCY_ALL (LATENCY_TOP_PRIORITY + 1)
+#define LATENCY_CLASSES (LATENCY_TOP_PRIORITY + 2)
+
+typedef struct {
+    Histogram wait[LATENCY_CLASSES];        // start_time - arrival_time
+    Histogram turnaround[LATENCY_CLASSES];  // finish_time - arrival_time
+} LatencyStats;
+
+typedef struct {
+    JobChunk** chunks;      // Chunk pointers; chunks[first_chunk] is the oldest
+    int first_chunk;
+    int chunk_count;        // Chunks in use, starting at first_chunk
+    int chunk_capacity;
+    JobChunk* spare;        // Emptied chunk kept for reuse
+    int head;               // Offset of the oldest retained job in the first chunk
+    int size;               // Number of retained jobs
+    int retention;          // Maximum retained jobs (0 = unlimited)
+    JobPool* pool;          // Evicted jobs are released here (may be NULL)
+    CompletionStats stats;
+    LatencyStats* latency;  // Also covers evicted jobs
 } JobList;
 
 #endif // STRUCTS_H
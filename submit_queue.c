@@ -0,0 +1,97 @@
+#include "submit_queue.h"
+#include <stdlib.h>
+
+SubmitQueue* sq_create(int capacity) {
+    if (capacity < 2) {
+        capacity = 2;
+    }
+    unsigned int size = 1;
+    while (size < (unsigned int)capacity) {
+        size *= 2;
+    }
+    
+    SubmitQueue* sq = (SubmitQueue*)malloc(sizeof(SubmitQueue));
+    if (!sq) {
+        return NULL;
+    }
+    
+    sq->slots = (SubmitSlot*)malloc(size * sizeof(SubmitSlot));
+    if (!sq->slots) {
+        free(sq);
+        return NULL;
+    }
+    
+    // Slot i is first written by the producer that claims position i
+    for (unsigned int i = 0; i < size; i++) {
+        atomic_init(&sq->slots[i].sequence, i);
+    }
+    sq->mask = size - 1;
+    atomic_init(&sq->tail, 0);
+    sq->head = 0;
+    return sq;
+}
+
+int sq_push(SubmitQueue* sq, const Job* job) {
+    if (!sq || !job) {
+        return 0;
+    }
+    
+    unsigned int pos = atomic_load_explicit(&sq->tail, memory_order_relaxed);
+    while (1) {
+        SubmitSlot* slot = &sq->slots[pos & sq->mask];
+        unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int diff = (int)(sequence - pos);
+        
+        if (diff == 0) {
+            // The slot is free for this position: claim it. On failure
+            // another producer got there first and pos is reloaded
+            if (atomic_compare_exchange_weak_explicit(&sq->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                slot->job = *job;
+                atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0; // Full: the consumer has not read this slot's last lap yet
+        } else {
+            pos = atomic_load_explicit(&sq->tail, memory_order_relaxed); // Fell behind
+        }
+    }
+}
+
+int sq_pop(SubmitQueue* sq, Job* job) {
+    if (!sq || !job) {
+        return 0;
+    }
+    
+    SubmitSlot* slot = &sq->slots[sq->head & sq->mask];
+    unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (sequence != sq->head + 1) {
+        return 0; // Empty, or still being written
+    }
+    
+    *job = slot->job;
+    
+    // Hand the slot to the producer that claims it on the next lap
+    atomic_store_explicit(&slot->sequence, sq->head + sq->mask + 1, memory_order_release);
+    sq->head++;
+    return 1;
+}
+
+int sq_has_ready(SubmitQueue* sq) {
+    if (!sq) {
+        return 0;
+    }
+    
+    SubmitSlot* slot = &sq->slots[sq->head & sq->mask];
+    return atomic_load_explicit(&slot->sequence, memory_order_acquire) == sq->head + 1;
+}
+
+void sq_free(SubmitQueue* sq) {
+    if (!sq) {
+        return;
+    }
+    
+    free(sq->slots);
+    free(sq);
+}
@@ -0,0 +1,50 @@
+#ifndef SUBMIT_QUEUE_H
+#define SUBMIT_QUEUE_H
+
+#include <stdatomic.h>
+#include "structs.h"
+
+// Room for one submission. The sequence number says whose turn the slot is:
+// a producer claiming position pos may write it when sequence == pos, and
+// the consumer may read it when sequence == pos + 1
+typedef struct {
+    atomic_uint sequence;
+    Job job;
+} SubmitSlot;
+
+// Bounded lock-free ring of job submissions with many producers and a single
+// consumer. Producers claim a position with one compare-and-swap on tail and
+// never wait for each other or for the consumer; a full ring is reported
+// instead. Submissions from one producer are read in the order it pushed them
+typedef struct {
+    SubmitSlot* slots;
+    unsigned int mask;      // Capacity - 1 (capacity is a power of two)
+    char pad1[64];          // Keep producers' and consumer's counters on separate cache lines
+    atomic_uint tail;       // Next position a producer claims
+    char pad2[64];
+    unsigned int head;      // Next position the consumer reads (consumer only)
+} SubmitQueue;
+
+// Create a ring holding at least capacity submissions
+// Returns NULL on failure
+SubmitQueue* sq_create(int capacity);
+
+// Submit a copy of a job (only priority, required_cpu, required_ram and
+// duration are used; the rest is filled in when the job is admitted)
+// Safe to call from any number of threads at once
+// Returns 1 on success, 0 if the ring is full
+int sq_push(SubmitQueue* sq, const Job* job);
+
+// Take the oldest submission, copying it into *job (consumer thread only)
+// Returns 1 on success, 0 if nothing is ready. A submission whose producer
+// has claimed its slot but not finished writing it holds back the ones
+// behind it until it is written
+int sq_pop(SubmitQueue* sq, Job* job);
+
+// Whether sq_pop would return a submission right now (consumer thread only)
+int sq_has_ready(SubmitQueue* sq);
+
+// Free the ring (no producer may still be using it)
+void sq_free(SubmitQueue* sq);
+
+#endif // SUBMIT_QUEUE_H
@@ -154,6 +154,302 @@ else
     echo -e "${YELLOW}Test 9: Load State... SKIPPED (no saved state)${NC}"
 fi
 
+# Test 10: Fast-forward
+echo "Test 10: Fast-forward"
+cat > /tmp/test10.in <<EOF
+add-node 100 200
+add-job 1 30 50 3
+add-job 2 30 50 1000
+run-ticks 100000
+exit
+EOF
+run_test "Fast-Forward" /tmp/test10.in "time 100000 (100000 ticks, 3 scheduler passes, 2 jobs completed)"
+
+# Test 11: Placement policy
+echo "Test 11: Placement policy"
+cat > /tmp/test11.in <<EOF
+add-node 100 100
+add-node 40 40
+set-policy best-fit
+add-job 1 30 30 5
+run-tick
+status
+exit
+EOF
+run_test "Best-Fit Placement" /tmp/test11.in "Duration=5 (Node 2)"
+
+# Test 12: Bounded completed history
+echo "Test 12: Bounded completed history"
+cat > /tmp/test12.in <<EOF
+add-node 100 200
+set-history 2
+add-job 1 10 10 1
+add-job 1 10 10 1
+add-job 1 10 10 1
+run-ticks 5
+status
+exit
+EOF
+run_test "Completed History" /tmp/test12.in "Total: 3 jobs (2 retained)"
+
+# Test 13: Text export round trip
+echo "Test 13: Text export"
+cat > /tmp/test13.in <<EOF
+add-node 100 200
+add-job 1 30 50 3
+run-tick
+export /tmp/test_state_export.txt
+load /tmp/test_state_export.txt
+status
+exit
+EOF
+run_test "Text Export" /tmp/test13.in "Duration=3 (Node 1)"
+
+# Test 14: Journal recovery (the second run rebuilds the queue and the
+# running job from the checkpoint plus the records after it)
+echo "Test 14: Journal recovery"
+rm -f /tmp/test_journal.log /tmp/test14.snap
+cat > /tmp/test14a.in <<EOF
+add-node 100 200
+add-job 1 30 50 5
+run-tick
+save /tmp/test14.snap
+add-job 2 90 10 3
+run-tick
+EOF
+cat > /tmp/test14b.in <<EOF
+status
+exit
+EOF
+./scheduler --journal /tmp/test_journal.log < /tmp/test14a.in > /dev/null 2>&1
+./scheduler --journal /tmp/test_journal.log < /tmp/test14b.in > /tmp/test14.out 2>&1
+if grep -q "Recovered 3 journal records" /tmp/test14.out && \
+   grep -q "Next: Job 2 (Priority=2, CPU=90, RAM=10" /tmp/test14.out && \
+   grep -q "Job 1: Priority=1, CPU=30, RAM=50, Duration=4 (Node 1)" /tmp/test14.out && \
+   grep -q "Node 1: CPU 70/100, RAM 150/200" /tmp/test14.out && \
+   [ ! -e /tmp/test14.snap.tmp ] && [ ! -e /tmp/test_journal.log.tmp ]; then
+    echo -e "${GREEN}Test 14: Journal Recovery... PASSED${NC}"
+    ((TESTS_PASSED++))
+else
+    echo -e "${RED}Test 14: Journal Recovery... FAILED${NC}"
+    ((TESTS_FAILED++))
+fi
+
+# Test 15: Batch submission
+echo "Test 15: Batch submission"
+printf '# priority cpu ram duration\n3 10 10 2\n1 20 20 3\n2 5 5 1\n' > /tmp/test_batch.txt
+cat > /tmp/test15.in <<EOF
+add-node 100 200
+submit-batch /tmp/test_batch.txt
+status
+exit
+EOF
+run_test "Batch Submission" "/tmp/test15.in" "Next: Job 2 (Priority=1"
+
+# Test 16: Bucket queue keeps arrival order within a priority
+echo "Test 16: Bucket queue"
+cat > /tmp/test16.in <<EOF
+add-node 100 200
+set-queue bucket
+add-job 2 10 10 3
+add-job 1 10 10 3
+add-job 1 20 20 3
+status
+exit
+EOF
+run_test "Bucket Queue" "/tmp/test16.in" "Next: Job 2 (Priority=1"
+
+# Test 17: Cancel and reprioritize pending jobs
+echo "Test 17: Cancel and reprioritize"
+cat > /tmp/test17.in <<EOF
+add-node 100 200
+add-job 1 10 10 3
+add-job 2 10 10 3
+add-job 3 10 10 3
+cancel 1
+set-priority 3 0
+status
+exit
+EOF
+run_test "Cancel And Reprioritize" "/tmp/test17.in" "Next: Job 3 (Priority=0"
+
+# Test 18: Aging lets a long-waiting low-priority job go first
+echo "Test 18: Aging"
+cat > /tmp/test18.in <<EOF
+add-node 10 10
+set-aging 1
+add-job 0 10 10 20
+add-job 9 10 10 1
+run-ticks 12
+add-job 0 10 10 1
+status
+exit
+EOF
+run_test "Aging" "/tmp/test18.in" "Next: Job 2 (Priority=9"
+
+# Test 19: Backfilling around a blocked job
+echo "Test 19: Backfilling"
+cat > /tmp/test19.in <<EOF
+add-node 100 100
+add-job 1 80 80 10
+add-job 1 50 50 5
+add-job 2 10 10 3
+run-tick
+status
+exit
+EOF
+run_test "Backfilling" "/tmp/test19.in" "Job 3: Priority=2, CPU=10, RAM=10, Duration=3 (Node 1)"
+
+# Test 20: Placement pass is skipped when nothing changed
+echo "Test 20: Dirty tracking"
+cat > /tmp/test20.in <<EOF
+add-node 10 10
+add-job 1 10 10 100
+add-job 1 10 10 5
+run-tick
+run-tick
+run-tick
+status
+exit
+EOF
+run_test "Dirty Tracking" "/tmp/test20.in" "Placement passes: 1 run, 2 skipped"
+
+# Test 21: Submission ring under concurrent producers (separate binary)
+echo "Test 21: Submission ring stress"
+echo -n "Testing: Submission Ring... "
+if make -s stress_test > /tmp/test_output.txt 2>&1 &&
+   ./stress_test 4 20000 >> /tmp/test_output.txt 2>&1 &&
+   grep -q "no loss or duplication" /tmp/test_output.txt; then
+    echo -e "${GREEN}PASSED${NC}"
+    ((TESTS_PASSED++))
+else
+    echo -e "${RED}FAILED${NC}"
+    echo "  Expected: no loss or duplication"
+    ((TESTS_FAILED++))
+fi
+
+# Test 22: Metrics counters (needs a build with metrics enabled)
+echo "Test 22: Metrics"
+cat > /tmp/test22.in <<EOF
+add-node 10 10
+add-job 1 5 5 2
+add-job 1 8 8 2
+run-ticks 5
+stats
+exit
+EOF
+run_test "Metrics" "/tmp/test22.in" "Placement attempts: 3 (failures: 1)"
+
+# Test 23: Latency percentiles survive history eviction
+echo "Test 23: Latency Histograms"
+cat > /tmp/test23.in <<EOF
+set-history 1
+add-node 4 4
+add-job 2 4 4 3
+add-job 2 4 4 3
+add-job 2 4 4 3
+run-until-idle
+latency 2
+exit
+EOF
+run_test "Latency Histograms" "/tmp/test23.in" "Wait:       p50=4 p99=7 p99.9=7 max=7"
+
+# Test 24: Trace buffer keeps the newest events once full
+echo "Test 24: Trace Export"
+cat > /tmp/test24.in <<EOF
+add-node 8 8
+trace on 6
+add-job 1 4 4 2
+add-job 1 4 4 2
+run-until-idle
+trace dump /tmp/test24.json
+exit
+EOF
+run_test "Trace Export" "/tmp/test24.in" "Trace written to /tmp/test24.json (6 events)"
+
+# Test 25: Trace replay (CSV: submit time, priority, cpu, ram, duration)
+echo "Test 25: Trace Replay"
+cat > /tmp/test25.csv <<EOF
+submit_time,priority,cpu,ram,duration
+0,1,4,4,3
+0,1,4,4,3
+2,0,8,8,2
+5,2,4,4,1
+EOF
+cat > /tmp/test25.in <<EOF
+add-node 8 8
+add-node 4 4
+replay /tmp/test25.csv
+exit
+EOF
+run_test "Trace Replay" "/tmp/test25.in" "Simulated time: 0 to 7 (makespan 7 ticks)"
+
+# A journaled replay records its submissions and the default history bound,
+# so recovery does not need the trace
+rm -f /tmp/test_replay_journal.log
+./scheduler --journal /tmp/test_replay_journal.log < /tmp/test25.in > /dev/null 2>&1
+rm -f /tmp/test25.csv
+echo "status" | ./scheduler --journal /tmp/test_replay_journal.log > /tmp/test25_recovered.txt 2>&1
+if grep -q "Simulation advanced to time 7" /tmp/test25_recovered.txt &&
+   grep -q "Total: 4 jobs" /tmp/test25_recovered.txt &&
+   grep -q "^set-history 10000$" /tmp/test_replay_journal.log &&
+   ! grep -q "^replay" /tmp/test_replay_journal.log; then
+    echo -e "${GREEN}Test 25: Trace Replay Recovery... PASSED${NC}"
+    ((TESTS_PASSED++))
+else
+    echo -e "${RED}Test 25: Trace Replay Recovery... FAILED${NC}"
+    ((TESTS_FAILED++))
+fi
+
+# Test 26: Completions collected on worker threads give the serial output
+echo "Test 26: Parallel Completion Drain"
+echo -n "Testing: Parallel Completion Drain... "
+{
+    for node in 1 2 3 4 5 6; do
+        echo "add-node 32 32"
+    done
+    for job in $(seq 1 400); do
+        echo "add-job $((job % 5)) $((job % 7 + 1)) $((job % 5 + 1)) $((job % 4 + 1))"
+        if [ $((job % 25)) -eq 0 ]; then
+            echo "run-ticks 2"
+            echo "status"
+        fi
+    done
+    echo "run-until-idle"
+    echo "status"
+    echo "latency"
+    echo "exit"
+} > /tmp/test26.in
+./scheduler --threads 1 < /tmp/test26.in > /tmp/test26_serial.txt 2>&1
+./scheduler --threads 4 < /tmp/test26.in > /tmp/test26_parallel.txt 2>&1
+if grep -q "Completed Jobs" /tmp/test26_serial.txt &&
+   cmp -s /tmp/test26_serial.txt /tmp/test26_parallel.txt; then
+    echo -e "${GREEN}PASSED${NC}"
+    ((TESTS_PASSED++))
+else
+    echo -e "${RED}FAILED${NC}"
+    echo "  Expected: identical output with --threads 1 and --threads 4"
+    ((TESTS_FAILED++))
+fi
+
+# Test 27: Identical blocked jobs do not use up the backfill depth
+echo "Test 27: Backfill Past Repeated Shapes"
+cat > /tmp/test27.in <<EOF
+set-backfill 2
+add-node 8 8
+add-job 0 6 6 10
+run-tick
+add-job 0 8 8 2
+add-job 1 4 4 1
+add-job 1 4 4 1
+add-job 1 4 4 1
+add-job 1 2 2 1
+run-tick
+status
+exit
+EOF
+run_test "Backfill Past Repeated Shapes" "/tmp/test27.in" "Job 6: Priority=1, CPU=2, RAM=2, Duration=1 (Node 1)"
+
 # Summary
 echo ""
 echo "=== Test Summary ==="
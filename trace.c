@@ -0,0 +1,169 @@
+#include "trace.h"
+#include "priority_queue.h"
+#include "hash_table.h"
+#include "node_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Microseconds of trace time per simulated tick
+#define TRACE_US_PER_TICK 1000
+
+// Trace-event process IDs of the two timelines
+#define TRACE_PID_TICKS 1
+#define TRACE_PID_CLUSTER 2
+
+int trace_start(Tracer* trace, int capacity) {
+    if (capacity <= 0) {
+        return 0;
+    }
+    
+    TraceEvent* events = (TraceEvent*)malloc((size_t)capacity * sizeof(TraceEvent));
+    if (!events) {
+        return 0;
+    }
+    trace_stop(trace);
+    trace->events = events;
+    trace->capacity = capacity;
+    trace->next = 0;
+    trace->recorded = 0;
+    trace->origin_ns = metrics_now_ns();
+    return 1;
+}
+
+void trace_stop(Tracer* trace) {
+    free(trace->events);
+    trace->events = NULL;
+    trace->capacity = 0;
+    trace->next = 0;
+    trace->recorded = 0;
+}
+
+int trace_size(const Tracer* trace) {
+    if (trace->recorded < trace->capacity) {
+        return (int)trace->recorded;
+    }
+    return trace->capacity;
+}
+
+// Claim the next slot, overwriting the oldest event when the buffer is full
+static TraceEvent* trace_slot(Tracer* trace) {
+    TraceEvent* event = &trace->events[trace->next];
+    if (++trace->next == trace->capacity) {
+        trace->next = 0;
+    }
+    trace->recorded++;
+    return event;
+}
+
+void trace_job(Tracer* trace, TraceEventType type, const Job* job, int node_id, int time) {
+    TraceEvent* event = trace_slot(trace);
+    event->time = time;
+    event->duration = job->duration;
+    event->type = type;
+    event->job_id = job->job_id;
+    event->node_id = node_id;
+    event->args[0] = job->priority;
+    event->args[1] = job->required_cpu;
+    event->args[2] = job->required_ram;
+}
+
+void trace_phase(Tracer* trace, MetricsPhase phase, long long start_ns, int tick) {
+    long long end_ns = metrics_now_ns();
+    TraceEvent* event = trace_slot(trace);
+    event->time = start_ns - trace->origin_ns;
+    event->duration = end_ns - start_ns;
+    event->type = TRACE_PHASE;
+    event->job_id = -1;
+    event->node_id = -1;
+    event->args[0] = phase;
+    event->args[1] = tick;
+}
+
+void trace_counters(Tracer* trace, PriorityQueue* pq, HashTable* running_jobs, int time) {
+    TraceEvent* event = trace_slot(trace);
+    event->time = time;
+    event->duration = 0;
+    event->type = TRACE_COUNTERS;
+    event->job_id = -1;
+    event->node_id = -1;
+    event->args[0] = pq_size(pq);
+    event->args[1] = ht_size(running_jobs);
+}
+
+static void write_event(FILE* file, const TraceEvent* event) {
+    long long ts = event->time * TRACE_US_PER_TICK;
+    switch (event->type) {
+        case TRACE_SUBMIT:
+            fprintf(file, "{\"name\":\"submit\",\"cat\":\"job\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":0,\"ts\":%lld,"
+                    "\"args\":{\"job\":%d,\"priority\":%d,\"cpu\":%d,\"ram\":%d}}",
+                    TRACE_PID_CLUSTER, ts, event->job_id, event->args[0], event->args[1], event->args[2]);
+            break;
+        case TRACE_PLACE:
+            fprintf(file, "{\"name\":\"Job %d\",\"cat\":\"job\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%lld,\"dur\":%lld,"
+                    "\"args\":{\"job\":%d,\"priority\":%d,\"cpu\":%d,\"ram\":%d}}",
+                    event->job_id, TRACE_PID_CLUSTER, event->node_id, ts, event->duration * TRACE_US_PER_TICK,
+                    event->job_id, event->args[0], event->args[1], event->args[2]);
+            break;
+        case TRACE_COMPLETE:
+            fprintf(file, "{\"name\":\"complete\",\"cat\":\"job\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%lld,"
+                    "\"args\":{\"job\":%d}}",
+                    TRACE_PID_CLUSTER, event->node_id, ts, event->job_id);
+            break;
+        case TRACE_PHASE:
+            fprintf(file, "{\"name\":\"%s\",\"cat\":\"tick\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"tick\":%d}}",
+                    metrics_phase_name((MetricsPhase)event->args[0]), TRACE_PID_TICKS,
+                    event->time / 1000.0, event->duration / 1000.0, event->args[1]);
+            break;
+        default: // TRACE_COUNTERS
+            fprintf(file, "{\"name\":\"jobs\",\"ph\":\"C\",\"pid\":%d,\"ts\":%lld,"
+                    "\"args\":{\"pending\":%d,\"running\":%d}}",
+                    TRACE_PID_CLUSTER, ts, event->args[0], event->args[1]);
+            break;
+    }
+}
+
+int trace_write(const Tracer* trace, const char* path, NodeList* nodes) {
+    if (!trace->events || !path) {
+        return 0;
+    }
+    
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return 0;
+    }
+    
+    // Timeline and lane names
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Scheduler ticks (wall clock)\"}},\n",
+            TRACE_PID_TICKS);
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Cluster (simulated time, 1 tick = 1 ms)\"}},\n",
+            TRACE_PID_CLUSTER);
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"Queue\"}}",
+            TRACE_PID_CLUSTER);
+    for (int i = 0; nodes && i < nodes->size; i++) {
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"Node %d\"}}",
+                TRACE_PID_CLUSTER, nodes->nodes[i]->node_id, nodes->nodes[i]->node_id);
+    }
+    
+    // Events, oldest first
+    int count = trace_size(trace);
+    int first = trace->recorded > trace->capacity ? trace->next : 0;
+    for (int i = 0; i < count; i++) {
+        int slot = first + i;
+        if (slot >= trace->capacity) {
+            slot -= trace->capacity;
+        }
+        fprintf(file, ",\n");
+        write_event(file, &trace->events[slot]);
+    }
+    
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"events_recorded\":%lld,\"events_overwritten\":%lld}}\n",
+            trace->recorded, trace->recorded - count);
+    
+    int ok = !ferror(file);
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    return ok;
+}
@@ -0,0 +1,71 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "structs.h"
+#include "metrics.h"
+
+// Scheduling timeline recorder. While tracing is on, job submissions,
+// placements and completions, tick phase timings and per-tick queue counts
+// are written into a ring buffer allocated when tracing starts (the oldest
+// events are overwritten once it is full), so recording an event is a slot
+// store with no allocation or I/O. trace_write turns the buffer into a
+// Chrome trace-event JSON file for chrome://tracing or ui.perfetto.dev
+// Each Scheduler has its own tracer; when it is off each hook is a single
+// test of a field of the scheduler
+
+typedef enum {
+    TRACE_SUBMIT,       // Job queued: args priority, cpu, ram
+    TRACE_PLACE,        // Job started: duration in ticks, args priority, cpu, ram
+    TRACE_COMPLETE,     // Job finished
+    TRACE_PHASE,        // Tick phase: time and duration in wall-clock ns, args phase, tick
+    TRACE_COUNTERS      // End of a tick: args pending, running
+} TraceEventType;
+
+typedef struct {
+    long long time;     // Simulated time (ns since tracing began for TRACE_PHASE)
+    long long duration;
+    int type;
+    int job_id;
+    int node_id;
+    int args[3];
+} TraceEvent;
+
+typedef struct {
+    TraceEvent* events; // NULL while tracing is off
+    int capacity;
+    int next;           // Slot the next event goes to
+    long long recorded; // Events recorded since tracing began (including overwritten ones)
+    long long origin_ns;
+} Tracer;
+
+#define TRACE_ACTIVE(sched) ((sched)->trace.events != NULL)
+#define TRACE_NOW(sched, var) long long var = TRACE_ACTIVE(sched) ? metrics_now_ns() : 0
+#define TRACE_JOB(sched, type, job, node_id, time) \
+    (TRACE_ACTIVE(sched) ? trace_job(&(sched)->trace, (type), (job), (node_id), (time)) : (void)0)
+#define TRACE_PHASE(sched, phase, start_ns, tick) \
+    (TRACE_ACTIVE(sched) ? trace_phase(&(sched)->trace, (phase), (start_ns), (tick)) : (void)0)
+#define TRACE_COUNTERS(sched, pq, running_jobs, time) \
+    (TRACE_ACTIVE(sched) ? trace_counters(&(sched)->trace, (pq), (running_jobs), (time)) : (void)0)
+
+// Start tracing into a buffer of capacity events, discarding any earlier
+// trace. Returns 1 on success, 0 on failure
+int trace_start(Tracer* trace, int capacity);
+
+// Stop tracing and free the buffer
+void trace_stop(Tracer* trace);
+
+// Events currently held in the buffer
+int trace_size(const Tracer* trace);
+
+// Hooks used by the macros above
+void trace_job(Tracer* trace, TraceEventType type, const Job* job, int node_id, int time);
+void trace_phase(Tracer* trace, MetricsPhase phase, long long start_ns, int tick);
+void trace_counters(Tracer* trace, PriorityQueue* pq, HashTable* running_jobs, int time);
+
+// Write the buffered events, oldest first, as Chrome trace-event JSON. Tick
+// phases appear on a wall-clock timeline; node occupancy and the queue on a
+// simulated-time timeline where one tick is one millisecond
+// Returns 1 on success, 0 on failure (or when tracing is off)
+int trace_write(const Tracer* trace, const char* path, NodeList* nodes);
+
+#endif // TRACE_H
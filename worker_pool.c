@@ -0,0 +1,139 @@
+#include "worker_pool.h"
+#include <stdlib.h>
+
+int wp_enabled(void) {
+#ifdef SCHED_THREADS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+#ifdef SCHED_THREADS
+// Claim and run tasks of the current batch until none are left (called and
+// returns with the lock held)
+static void run_tasks(WorkerPool* pool) {
+    while (pool->next < pool->count) {
+        int index = pool->next++;
+        wp_task task = pool->task;
+        void* arg = pool->arg;
+        pthread_mutex_unlock(&pool->lock);
+        task(index, arg);
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->done == pool->count) {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+}
+
+static void* worker_main(void* data) {
+    WorkerPool* pool = (WorkerPool*)data;
+    pthread_mutex_lock(&pool->lock);
+    unsigned int seen = pool->generation;
+    while (1) {
+        while (!pool->stop && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        seen = pool->generation;
+        run_tasks(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+#endif
+
+WorkerPool* wp_create(int threads) {
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > 1 && !wp_enabled()) {
+        return NULL; // No thread support in this build
+    }
+
+    WorkerPool* pool = (WorkerPool*)calloc(1, sizeof(WorkerPool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->threads = 1;
+
+#ifdef SCHED_THREADS
+    if (threads > 1) {
+        pool->ids = (pthread_t*)malloc((threads - 1) * sizeof(pthread_t));
+        if (!pool->ids) {
+            free(pool);
+            return NULL;
+        }
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&pool->ids[i], NULL, worker_main, pool) != 0) {
+            wp_free(pool);
+            return NULL;
+        }
+        pool->threads++;
+    }
+#endif
+    return pool;
+}
+
+int wp_threads(const WorkerPool* pool) {
+    return pool ? pool->threads : 1;
+}
+
+void wp_run(WorkerPool* pool, int count, wp_task task, void* arg) {
+    if (!task || count <= 0) {
+        return;
+    }
+
+#ifdef SCHED_THREADS
+    if (pool && pool->threads > 1) {
+        pthread_mutex_lock(&pool->lock);
+        pool->task = task;
+        pool->arg = arg;
+        pool->count = count;
+        pool->next = 0;
+        pool->done = 0;
+        pool->generation++;
+        pthread_cond_broadcast(&pool->work_ready);
+
+        run_tasks(pool);
+        while (pool->done < pool->count) {
+            pthread_cond_wait(&pool->work_done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+        return;
+    }
+#else
+    (void)pool;
+#endif
+
+    for (int i = 0; i < count; i++) {
+        task(i, arg);
+    }
+}
+
+void wp_free(WorkerPool* pool) {
+    if (!pool) {
+        return;
+    }
+
+#ifdef SCHED_THREADS
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->threads - 1; i++) {
+        pthread_join(pool->ids[i], NULL);
+    }
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->ids);
+#endif
+    free(pool);
+}
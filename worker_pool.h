@@ -0,0 +1,55 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#ifdef SCHED_THREADS
+#include <pthread.h>
+#endif
+
+// A fixed set of worker threads that run a batch of independent tasks and
+// return once all of them are done. Built on pthreads when SCHED_THREADS is
+// defined (the default Makefile build, "make THREADS=0" leaves it out);
+// otherwise only single-threaded pools can be created and every task runs
+// on the calling thread
+
+// One task of a batch; index is its position in the batch
+typedef void (*wp_task)(int index, void* arg);
+
+typedef struct {
+    int threads;            // Threads running tasks, counting the caller
+#ifdef SCHED_THREADS
+    pthread_t* ids;         // The threads - 1 started workers
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    // Current batch (guarded by lock)
+    wp_task task;
+    void* arg;
+    int count;              // Tasks in the batch
+    int next;               // Next task to claim
+    int done;               // Tasks finished
+    unsigned int generation; // Bumped for each batch
+    int stop;
+#endif
+} WorkerPool;
+
+// Whether this build can run tasks on more than one thread
+int wp_enabled(void);
+
+// Create a pool of threads threads in total, counting the thread that calls
+// wp_run (so threads - 1 workers are started)
+// Returns NULL on failure, or if threads > 1 and threads are disabled
+WorkerPool* wp_create(int threads);
+
+// Number of threads running tasks, counting the caller (1 for a NULL pool)
+int wp_threads(const WorkerPool* pool);
+
+// Run task(i, arg) for every i in [0, count) and wait for all of them. The
+// caller works on the batch too; tasks are claimed in index order by
+// whichever thread is free, so they must not depend on each other. A NULL
+// pool runs them in order on the caller
+void wp_run(WorkerPool* pool, int count, wp_task task, void* arg);
+
+// Stop the workers and free the pool
+void wp_free(WorkerPool* pool);
+
+#endif // WORKER_POOL_H